@@ -0,0 +1,359 @@
+#include <vector>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+
+#include <boost/multiprecision/mpfr.hpp>
+#include <boost/program_options.hpp>
+
+#include <ricpad/chebyshev.hpp>
+#include <ricpad/hankdet.hpp>
+#include <ricpad/precision.hpp>
+#include <solver/dual.hpp>
+#include <solver/solver.hpp>
+#include <tf.hpp>
+#include <tf_polynomials.hpp>
+
+namespace mp = boost::multiprecision;
+using mp::mpfr_float;
+typedef solver::dual<mpfr_float> dual_float;
+
+namespace po = boost::program_options;
+
+// ----------------------------------------------------------------------------
+// Allocation counters. Every operator new, and every allocation made by GMP
+// and MPFR through the GMP memory functions, is counted.
+// ----------------------------------------------------------------------------
+
+std::atomic<long> new_count(0), gmp_count(0);
+
+void* operator new(std::size_t size) {
+    new_count++;
+    if ( void* p = std::malloc(size ? size : 1) ) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    new_count++;
+    if ( void* p = std::malloc(size ? size : 1) ) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {std::free(p);}
+void operator delete[](void* p) noexcept {std::free(p);}
+void operator delete(void* p, std::size_t) noexcept {std::free(p);}
+void operator delete[](void* p, std::size_t) noexcept {std::free(p);}
+
+void* gmp_allocate(std::size_t size) {
+    gmp_count++;
+    return std::malloc(size);
+}
+
+void* gmp_reallocate(void* p, std::size_t, std::size_t size) {
+    gmp_count++;
+    return std::realloc(p, size);
+}
+
+void gmp_free(void* p, std::size_t) {std::free(p);}
+
+// ----------------------------------------------------------------------------
+// Measurements
+// ----------------------------------------------------------------------------
+
+// Cost of a kernel per call
+struct Cost {
+    long calls;
+    double seconds, news, gmps;
+};
+
+// Call kernel once to warm up, and then repeatedly until min_time seconds
+// have passed
+Cost measure(const std::function<void()> &kernel, const double min_time) {
+    kernel();
+
+    const long news0 = new_count, gmps0 = gmp_count;
+    const auto start = std::chrono::steady_clock::now();
+    long calls = 0;
+    double elapsed;
+
+    do {
+        kernel();
+        calls++;
+        elapsed = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+    } while ( elapsed < min_time );
+
+    return Cost{
+        calls, elapsed/calls,
+        double(new_count - news0)/calls, double(gmp_count - gmps0)/calls};
+}
+
+// Number of decimal digits in which x and reference agree
+int agreement(const mpfr_float &x, const mpfr_float &reference) {
+    mpfr_float diff = abs(x - reference);
+    if ( diff == 0 ) return mpfr_float::default_precision();
+    if ( reference == 0 ) return -int(ceil(log10(diff)));
+
+    return std::max(0, -int(ceil(log10(diff/abs(reference)))));
+}
+
+// Print one line of results. expected is the number of digits in which the
+// result should agree with its reference; the check is skipped if it is not
+// positive.
+void report(
+        const std::string &kernel, const int D, const int N, const int digits,
+        const Cost &cost, const int agree, const int expected
+        ) {
+    std::cout
+        << std::left << std::setw(13) << kernel << std::right
+        << std::setw(6) << D << std::setw(7) << N << std::setw(7) << digits
+        << std::setw(8) << cost.calls
+        << std::setw(13) << std::scientific << std::setprecision(3)
+        << cost.seconds << std::fixed << std::setprecision(1)
+        << std::setw(10) << cost.news << std::setw(10) << cost.gmps
+        << std::setw(7) << agree << std::setw(7) << expected << "  "
+        << ( expected <= 0 ? "n/a" : agree >= expected ? "ok" : "FAIL" )
+        << std::endl;
+}
+
+// ----------------------------------------------------------------------------
+// Reference points
+// ----------------------------------------------------------------------------
+
+// Slope at the origin of the solution of the isolated atom equation
+const char* isolated_slope =
+    "-1.588071022611375312718684509423950109452746621674825616765677418166"
+    "551961154309262577";
+
+// Limit of the roots of H[D,4] for the strong field equation
+const char* strong_slope =
+    "-0.938966887643958893055053401874601";
+
+// Digits lost to cancellation in H[D,d] per unit of D
+const double loss_per_D = 1.3;
+
+// Storage reused by the evaluations of strong_hankel, created again when the
+// precision changes
+template <typename num_t>
+struct Workspace {
+    unsigned digits;
+    Series<num_t> series;
+    ricpad::hankdet::Workspace<num_t> hankdet;
+
+    Workspace() :
+        digits(ricpad::precision<num_t>::get()), series(num_t(0), true) {};
+};
+
+// H[D,d] for the strong field equation as a function of x
+template <typename num_t>
+num_t strong_hankel(const int D, const int d, num_t &x) {
+    static std::unique_ptr<Workspace<num_t>> ws;
+    if ( ! ws || ws->digits != ricpad::precision<num_t>::get() )
+        ws.reset(new Workspace<num_t>());
+
+    ws->series.reset(x/2);
+    ws->series.extend(2*D+d);
+
+    return ricpad::hankdet::hankdet<num_t>(
+            D, ws->series.data() + d + 1, ws->hankdet);
+}
+
+int main(int argc, char* argv[]) {
+    mp_set_memory_functions(&gmp_allocate, &gmp_reallocate, &gmp_free);
+
+    po::options_description optional("Options");
+    po::variables_map vm;
+
+    optional.add_options()
+        ("help", "Print this message")
+        ("kernels", po::value<std::vector<std::string>>()->multitoken()
+         ->default_value({"coefs", "coefs_strong", "polynomial", "hankdet",
+                          "chebyshev", "solve"},
+                         "coefs coefs_strong polynomial hankdet chebyshev "
+                         "solve"),
+         "Kernels to measure. coefs and coefs_strong run the recurrences "
+         "for the series, polynomial evaluates the series from exact "
+         "polynomials, hankdet and chebyshev compute H[D,3] of the isolated "
+         "atom series with Dodgson condensation and the Chebyshev "
+         "algorithm, and solve finds the root of H[D,4] for the strong "
+         "field equation with Newton's method and the exact derivative.")
+        ("D", po::value<std::vector<int>>()->multitoken()
+         ->default_value({10, 20, 50, 100}, "10 20 50 100"),
+         "Values of D. The series have N = 2*D+d coefficients.")
+        ("digits", po::value<std::vector<int>>()->multitoken()
+         ->default_value({40, 100, 500}, "40 100 500"),
+         "Working precisions, in decimal digits.")
+        ("min-time", po::value<double>()->default_value(0.2),
+         "Minimum time spent measuring each kernel, in seconds.")
+        ;
+
+    po::store(po::parse_command_line(argc, argv, optional), vm);
+    po::notify(vm);
+
+    if ( vm.count("help") ) {
+        std::cout << optional << std::endl;
+        return 1;
+    }
+
+    const auto kernels = vm["kernels"].as<std::vector<std::string>>();
+    const auto Ds = vm["D"].as<std::vector<int>>();
+    const auto digits_list = vm["digits"].as<std::vector<int>>();
+    const double min_time = vm["min-time"].as<double>();
+
+    for ( const auto &kernel : kernels ) {
+        if ( kernel != "coefs" && kernel != "coefs_strong"
+                && kernel != "polynomial" && kernel != "hankdet"
+                && kernel != "chebyshev" && kernel != "solve" ) {
+            std::cout << "Unknown kernel " << kernel << "." << std::endl;
+            return 1;
+        }
+    }
+
+    for ( int D : Ds ) {
+        if ( D < 3 ) {
+            std::cout << "D should be at least 3." << std::endl;
+            return 1;
+        }
+    }
+
+    for ( int digits : digits_list ) {
+        if ( digits < 15 ) {
+            std::cout << "digits should be at least 15." << std::endl;
+            return 1;
+        }
+    }
+
+    // Results are checked against the same computation with twice the
+    // digits, except for the polynomial series, which is checked against
+    // the recurrence.
+    std::cout
+        << std::left << std::setw(13) << "kernel" << std::right
+        << std::setw(6) << "D" << std::setw(7) << "N"
+        << std::setw(7) << "digits" << std::setw(8) << "calls"
+        << std::setw(13) << "s/call" << std::setw(10) << "new/call"
+        << std::setw(10) << "gmp/call" << std::setw(7) << "agree"
+        << std::setw(7) << "expect" << "  check" << std::endl;
+
+    SeriesPolynomials polynomials(false);
+
+    for ( const auto &kernel : kernels ) {
+        for ( int D : Ds ) {
+            for ( int digits : digits_list ) {
+                const bool strong = kernel == "coefs_strong"
+                    || kernel == "solve";
+                const int d = strong ? 4 : 3, N = 2*D+d;
+                const char* slope = strong ? strong_slope : isolated_slope;
+
+                // Result of the kernel, with digits and 2*digits digits
+                mpfr_float result, reference;
+                std::function<void()> run;
+                Cost cost;
+                int expected = digits - 10;
+                std::string note;
+
+                try {
+                for ( int pass = 0; pass < 2; pass++ ) {
+                    const int p = pass == 0 ? 2*digits : digits;
+                    ricpad::precision<mpfr_float>::set(p);
+
+                    mpfr_float f2(slope);
+                    f2 /= 2;
+
+                    std::vector<mpfr_float> v;
+                    ricpad::hankdet::Workspace<mpfr_float> ws;
+                    SeriesPolynomials::Workspace<mpfr_float> pws;
+                    mpfr_float x, y;
+
+                    if ( kernel == "coefs" ) {
+                        run = [&] () {v = coefs<mpfr_float>(N, f2);};
+                    } else if ( kernel == "coefs_strong" ) {
+                        run = [&] () {v = coefs_strong<mpfr_float>(N, f2);};
+                    } else if ( kernel == "polynomial" ) {
+                        polynomials.extend(N);
+                        run = [&] () {
+                            v = polynomials.coefs<mpfr_float>(N, f2, pws);
+                        };
+                    } else if ( kernel == "hankdet" ) {
+                        v = coefs<mpfr_float>(N, f2);
+                        run = [&] () {
+                            x = ricpad::hankdet::hankdet<mpfr_float>(
+                                    D, v.data() + d + 1, ws);
+                        };
+                        expected = digits - int(loss_per_D*D) - 5;
+                    } else if ( kernel == "chebyshev" ) {
+                        v = coefs<mpfr_float>(N, f2);
+                        std::vector<mpfr_float> c(
+                                v.begin() + d + 1, v.begin() + d + 2*D);
+                        run = [&, c] () {
+                            x = ricpad::hankdet::hankdet_chebyshev<
+                                mpfr_float>(D, c);
+                        };
+                        expected = digits - int(loss_per_D*D) - 5;
+                    } else {
+                        run = [&] () {
+                            std::function<dual_float(dual_float&)> fd =
+                                [D, d] (dual_float &z) -> dual_float {
+                                    return strong_hankel<dual_float>(D, d, z);
+                                };
+                            solver::Solver<mpfr_float, mpfr_float> s(fd);
+                            s.set_tol(pow(mpfr_float(10), -expected));
+                            s.set_maxiter(50);
+                            x = s.solve(2*f2);
+                        };
+                        expected = digits - int(loss_per_D*D) - 10;
+                    }
+
+                    if ( pass == 0 ) {
+                        if ( kernel == "solve" && expected <= 0 ) break;
+                        if ( kernel == "polynomial" )
+                            v = coefs<mpfr_float>(N, f2);
+                        else
+                            run();
+                    } else {
+                        cost = measure(run, min_time);
+                    }
+
+                    if ( kernel == "coefs" || kernel == "coefs_strong"
+                            || kernel == "polynomial" )
+                        x = v[N];
+
+                    (pass == 0 ? reference : result) = x;
+
+                    // Compare the polynomial series with the recurrence at
+                    // the same precision
+                    if ( kernel == "polynomial" && pass == 1 ) {
+                        v = coefs<mpfr_float>(N, f2);
+                        reference = v[N];
+                    }
+                }
+                } catch ( const std::runtime_error& e ) {
+                    note = std::string("FAIL: ") + e.what();
+                }
+
+                if ( kernel == "solve" && expected <= 0 )
+                    note = "skipped: not enough digits for this D";
+
+                if ( ! note.empty() ) {
+                    std::cout
+                        << std::left << std::setw(13) << kernel << std::right
+                        << std::setw(6) << D << std::setw(7) << N
+                        << std::setw(7) << digits << "  " << note
+                        << std::endl;
+                    continue;
+                }
+
+                ricpad::precision<mpfr_float>::set(2*digits);
+                report(kernel, D, N, digits, cost,
+                        agreement(result, reference), expected);
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,152 @@
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <boost/math/constants/constants.hpp>
+
+#ifndef RICPAD_ABERTH
+#define RICPAD_ABERTH
+
+namespace ricpad::aberth {
+
+// Complex numbers on any real type T, with the few operations needed here
+template <class T>
+struct Complex {
+    T re, im;
+};
+
+template <class T>
+Complex<T> operator+(const Complex<T>& a, const Complex<T>& b) {
+    return Complex<T>{a.re + b.re, a.im + b.im};
+}
+
+template <class T>
+Complex<T> operator-(const Complex<T>& a, const Complex<T>& b) {
+    return Complex<T>{a.re - b.re, a.im - b.im};
+}
+
+template <class T>
+Complex<T> operator*(const Complex<T>& a, const Complex<T>& b) {
+    return Complex<T>{a.re*b.re - a.im*b.im, a.re*b.im + a.im*b.re};
+}
+
+template <class T>
+Complex<T> operator/(const Complex<T>& a, const Complex<T>& b) {
+    const T n = b.re*b.re + b.im*b.im;
+    return Complex<T>{
+        (a.re*b.re + a.im*b.im)/n, (a.im*b.re - a.re*b.im)/n};
+}
+
+template <class T>
+T abs(const Complex<T>& a) {
+    using std::sqrt;
+    return sqrt(a.re*a.re + a.im*a.im);
+}
+
+// All the roots of the polynomial a[0] + a[1]*z + ... + a[n]*z^n, with real
+// coefficients and a[n] != 0, by the Aberth-Ehrlich iteration: every
+// approximation z[k] takes the step
+//
+//     w = N/(1 - N*sum_{j != k} 1/(z[k] - z[j])),    N = p(z[k])/p'(z[k]),
+//
+// which is Newton's step for p(z)/prod_{j != k}(z - z[j]), so that the roots
+// already found repel the others. The approximations start on a circle
+// whose radius is the geometric mean of the moduli of the roots, and are
+// updated one after the other with the latest values of the rest. An
+// approximation stops moving when its step is below tol relative to it (or
+// absolutely, if it is close to zero), or when p(z[k]) is as small as the
+// rounding errors of its evaluation, so that no precision of T can improve
+// it. The iteration stops when all of them have stopped or after maxiter
+// sweeps; iterations is set to the sweeps done, and converged to whether
+// they stopped for the first reason.
+template <class T>
+std::vector<Complex<T>> roots(
+        const std::vector<T>& a,
+        const T& tol,
+        const int maxiter,
+        int* iterations = nullptr,
+        bool* converged = nullptr
+        ) {
+    using std::abs;
+    using std::pow;
+    using std::cos;
+    using std::sin;
+    typedef Complex<T> C;
+
+    int n = int(a.size()) - 1;
+    while ( n > 0 && a[n] == 0 ) n--;
+
+    std::vector<C> z;
+    if ( iterations ) *iterations = 0;
+    if ( converged ) *converged = true;
+    if ( n <= 0 ) return z;
+
+    // Roots at zero
+    int zeros = 0;
+    while ( a[zeros] == 0 ) zeros++;
+    const int m = n - zeros;
+    const T* b = a.data() + zeros;
+
+    const T radius = m > 0 ? T(pow(T(abs(b[0]/b[m])), T(1)/m)) : T(0);
+    const T pi = boost::math::constants::pi<T>();
+    for ( int k = 0; k < m; k++ ) {
+        const T angle = 2*pi*k/m + T(0.4);
+        z.push_back(C{radius*cos(angle), radius*sin(angle)});
+    }
+
+    const T eps = std::numeric_limits<T>::epsilon();
+    std::vector<bool> done(m, false);
+    int sweep;
+
+    for ( sweep = 1; sweep <= maxiter; sweep++ ) {
+        bool all_done = true;
+
+        for ( int k = 0; k < m; k++ ) {
+            if ( done[k] ) continue;
+
+            // p(z[k]) and p'(z[k]) by Horner's scheme, and the bound 
+            // sum_i |b[i]|*|z[k]|^i for the rounding error of p(z[k])
+            C p{b[m], T(0)}, dp{T(0), T(0)};
+            const T r = abs(z[k]);
+            T bound = abs(b[m]);
+            for ( int i = m-1; i >= 0; i-- ) {
+                dp = dp*z[k] + p;
+                p = p*z[k] + C{b[i], T(0)};
+                bound = bound*r + abs(b[i]);
+            }
+
+            // z[k] is a root to within the rounding errors
+            if ( abs(p) <= 4*m*eps*bound ) {
+                done[k] = true;
+                continue;
+            }
+
+            C s{T(0), T(0)};
+            for ( int j = 0; j < m; j++ )
+                if ( j != k ) s = s + C{T(1), T(0)}/(z[k] - z[j]);
+
+            const C N = p/dp;
+            const C w = N/(C{T(1), T(0)} - N*s);
+            z[k] = z[k] - w;
+
+            const T size = abs(z[k]);
+            if ( abs(w) <= tol*(size > 1 ? size : T(1)) ) {
+                done[k] = true;
+            } else {
+                all_done = false;
+            }
+        }
+
+        if ( all_done ) break;
+    }
+
+    if ( iterations ) *iterations = std::min(sweep, maxiter);
+    if ( converged ) *converged = sweep <= maxiter;
+
+    for ( int k = 0; k < zeros; k++ ) z.push_back(C{T(0), T(0)});
+
+    return z;
+}
+
+} // namespace
+#endif
@@ -0,0 +1,184 @@
+#include <vector>
+#include <limits>
+#include <utility>
+#include <algorithm>
+#include <boost/math/policies/error_handling.hpp>
+
+#ifndef RICPAD_CHEBYSHEV
+#define RICPAD_CHEBYSHEV
+
+namespace ricpad::hankdet {
+
+// Hankel determinant by Gaussian elimination with partial pivoting on the
+// explicit D x D matrix. This costs O(D^3) operations and O(D^2) storage, and
+// is used when the O(D^2) methods below break down.
+template <class T>
+T hankdet_lu(
+        const int D,
+        // Coefficients c[0]...c[2*D-2]
+        const std::vector<T>& coefs
+        ) {
+    using std::vector;
+    static const char* function = "ricpad::hankdet::hankdet_lu<%1%>";
+
+    if ( int(coefs.size()) < 2*D-1 ) {
+        return boost::math::policies::raise_evaluation_error(
+            function,
+            "Input vector coefs should contain at least %1% elements. ",
+            2*D-1,
+            boost::math::policies::policy<>());
+    }
+
+    if ( D == 0 ) return 1;
+
+    vector<vector<T>> a(D, vector<T>(D));
+    for ( int i = 0; i < D; i++ )
+        for ( int j = 0; j < D; j++ )
+            a[i][j] = coefs[i+j];
+
+    T det(1);
+
+    for ( int k = 0; k < D; k++ ) {
+        int p = k;
+        for ( int i = k+1; i < D; i++ ) {
+            if ( abs(a[i][k]) > abs(a[p][k]) ) p = i;
+        }
+
+        if ( a[p][k] == 0 ) return 0;
+
+        if ( p != k ) {
+            std::swap(a[p], a[k]);
+            det = -det;
+        }
+
+        det *= a[k][k];
+
+        for ( int i = k+1; i < D; i++ ) {
+            T m = a[i][k]/a[k][k];
+            for ( int j = k+1; j < D; j++ ) {
+                a[i][j] -= m*a[k][j];
+            }
+        }
+    }
+
+    return det;
+}
+
+// Hankel determinants H_D for D = Dmin...Dmax with O(Dmax^2) operations and
+// O(Dmax) storage, using the Chebyshev algorithm: coefs are regarded as the
+// moments of a linear functional, and the determinants are products of the
+// squared norms sigma[k][k] of the associated monic orthogonal polynomials,
+//
+//     H_D = sigma[0][0] * sigma[1][1] * ... * sigma[D-1][D-1].
+//
+// Each sigma[k][k] is the ratio of two consecutive leading minors. When one of
+// them (except the last) vanishes or loses at least half of its digits to
+// cancellation the recurrence breaks down, and the remaining determinants are
+// computed with hankdet_lu instead.
+template <class T>
+std::vector<T> hankdets_chebyshev(
+        const int Dmin,
+        const int Dmax,
+        // Coefficients c[0]...c[2*Dmax-2]
+        const std::vector<T>& coefs,
+        // Set to true if the recurrence broke down
+        bool* breakdown = nullptr
+        ) {
+    using std::vector;
+    static const char* function = "ricpad::hankdet::hankdets_chebyshev<%1%>";
+
+    vector<T> dets;
+
+    if ( breakdown ) *breakdown = false;
+
+    if ( int(coefs.size()) < 2*Dmax-1 ) {
+        boost::math::policies::raise_evaluation_error(
+            function,
+            "Input vector coefs should contain at least %1% elements. ",
+            2*Dmax-1,
+            boost::math::policies::policy<>());
+        return dets;
+    }
+
+    // H_D for every D <= Dmax reached so far
+    T det(1);
+    if ( Dmin <= 0 ) dets.push_back(det);
+    if ( Dmax <= 0 ) return dets;
+
+    const T eps = std::numeric_limits<T>::epsilon();
+
+    // sigma[k-2][l], sigma[k-1][l] and sigma[k][l], for l = 0...2*Dmax-2
+    vector<T> sm2(2*Dmax-1, T(0)), s(sm2);
+    vector<T> sm1(coefs.begin(), coefs.begin()+2*Dmax-1);
+    T alpha, beta, scale;
+
+    det = coefs[0];
+    if ( Dmin <= 1 ) dets.push_back(det);
+
+    // Number of leading minors obtained by the recurrence
+    int D = 1;
+
+    if ( Dmax > 1 && coefs[0] != 0 ) {
+        alpha = coefs[1]/coefs[0];
+        beta  = coefs[0];
+
+        for ( int k = 1; k < Dmax; k++ ) {
+            for ( int l = k; l <= 2*(Dmax-1)-k; l++ ) {
+                s[l] = sm1[l+1] - alpha*sm1[l] - beta*sm2[l];
+            }
+
+            det *= s[k];
+            D = k+1;
+            if ( D >= Dmin ) dets.push_back(det);
+
+            if ( k == Dmax-1 ) break;
+
+            // Breakdown test: |s[k]| <= sqrt(eps)*scale, where scale is the
+            // largest of the terms that were added up to get s[k].
+            scale = abs(sm1[k+1]);
+            if ( abs(alpha*sm1[k]) > scale ) scale = abs(alpha*sm1[k]);
+            if ( abs(beta*sm2[k]) > scale ) scale = abs(beta*sm2[k]);
+
+            if ( s[k] == 0 || s[k]*s[k] <= eps*scale*scale ) break;
+
+            alpha = s[k+1]/s[k] - sm1[k]/sm1[k-1];
+            beta  = s[k]/sm1[k-1];
+
+            sm2.swap(sm1);
+            sm1.swap(s);
+        }
+    }
+
+    if ( D < Dmax && breakdown ) *breakdown = true;
+
+    for ( D = std::max(D+1, Dmin); D <= Dmax; D++ ) {
+        dets.push_back(hankdet_lu(D, coefs));
+    }
+
+    return dets;
+}
+
+// Hankel determinant H_D with O(D^2) operations, see hankdets_chebyshev.
+template <class T>
+T hankdet_chebyshev(
+        const int D,
+        // Coefficients c[0]...c[2*D-2]
+        const std::vector<T>& coefs,
+        // Set to true if the recurrence broke down
+        bool* breakdown = nullptr
+        ) {
+    static const char* function = "ricpad::hankdet::hankdet_chebyshev<%1%>";
+
+    if ( int(coefs.size()) < 2*D-1 ) {
+        return boost::math::policies::raise_evaluation_error(
+            function,
+            "Input vector coefs should contain at least %1% elements. ",
+            2*D-1,
+            boost::math::policies::policy<>());
+    }
+
+    return hankdets_chebyshev(D, D, coefs, breakdown)[0];
+}
+
+} // namespace
+#endif
@@ -0,0 +1,126 @@
+#include <vector>
+#include <boost/math/policies/error_handling.hpp>
+
+#ifndef RICPAD_EXTRAPOLATION
+#define RICPAD_EXTRAPOLATION
+
+namespace ricpad::extrapolation {
+
+// Estimates of the limit of a sequence s[0], s[1], ... from its terms. Each
+// method uses all the terms it is given, and returns the last term when it
+// has too few of them or when a denominator vanishes.
+
+// Iterated Aitken delta-squared process: the process is applied to s, then
+// to its result, and so on while at least three terms are left.
+template <class T>
+T aitken(std::vector<T> s) {
+    while ( s.size() >= 3 ) {
+        std::vector<T> t;
+
+        for ( int n = 0; n+2 < int(s.size()); n++ ) {
+            T d1 = s[n+2] - s[n+1], d0 = s[n+1] - s[n];
+            if ( d1 == d0 ) return s.back();
+
+            t.push_back(s[n+2] - d1*d1/(d1 - d0));
+        }
+
+        s = std::move(t);
+    }
+
+    return s.back();
+}
+
+// Richardson extrapolation to x = 0 of s[n] = s(x[n]), with s(x) a
+// polynomial in x (Neville's algorithm). For the Hankel-Pade sequences x[n] is
+// usually 1/D[n].
+template <class T>
+T richardson(std::vector<T> s, const std::vector<T>& x) {
+    static const char* function = "ricpad::extrapolation::richardson<%1%>";
+
+    if ( x.size() != s.size() ) {
+        return boost::math::policies::raise_evaluation_error(
+            function,
+            "Input vector x should contain %1% elements. ",
+            T(s.size()),
+            boost::math::policies::policy<>());
+    }
+
+    const int n = s.size();
+
+    // After step k, s[i] is the value at 0 of the polynomial through the
+    // points i-k...i
+    for ( int k = 1; k < n; k++ ) {
+        for ( int i = n-1; i >= k; i-- ) {
+            if ( x[i] == x[i-k] ) return s.back();
+            s[i] = (x[i]*s[i-1] - x[i-k]*s[i])/(x[i] - x[i-k]);
+        }
+    }
+
+    return s.back();
+}
+
+// Wynn's epsilon algorithm. The columns eps[k] with even k hold the Shanks
+// transforms of s, and the last entry of the highest even column is
+// returned.
+template <class T>
+T wynn(const std::vector<T>& s) {
+    const int n = s.size();
+    if ( n < 3 ) return s.back();
+
+    // Columns k-1 and k of the epsilon table, eps[-1] = 0 and eps[0] = s
+    std::vector<T> em1(n+1, T(0)), e(s), ep1;
+    T best = s.back();
+
+    for ( int k = 1; k < n; k++ ) {
+        ep1.clear();
+
+        for ( int i = 0; i+1 < int(e.size()); i++ ) {
+            T d = e[i+1] - e[i];
+            if ( d == 0 ) return best;
+
+            ep1.push_back(em1[i+1] + 1/d);
+        }
+
+        em1 = std::move(e);
+        e = std::move(ep1);
+        ep1 = std::vector<T>();
+
+        if ( k % 2 == 0 ) best = e.back();
+    }
+
+    return best;
+}
+
+// Levin's u transform with beta = 1, using the remainder estimates
+// w[n] = (n+1)*(s[n] - s[n-1]).
+template <class T>
+T levin(const std::vector<T>& s) {
+    const int n = s.size();
+    if ( n < 3 ) return s.back();
+
+    // The transform of order k uses s[1]...s[k+1]
+    const int k = n - 2;
+    T num(0), den(0), binom(1), w, c;
+
+    for ( int j = 0; j <= k; j++ ) {
+        const int m = j + 1;
+
+        w = (m+1)*(s[m] - s[m-1]);
+        if ( w == 0 ) return s.back();
+
+        c = binom*pow(T(m+1)/T(k+2), k-1)/w;
+        if ( j % 2 ) c = -c;
+
+        num += c*s[m];
+        den += c;
+
+        binom = binom*(k-j)/(j+1);
+    }
+
+    if ( den == 0 ) return s.back();
+
+    return num/den;
+}
+
+} // namespace
+#endif
@@ -1,6 +1,13 @@
 #include <vector>
+#include <future>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <boost/math/policies/error_handling.hpp>
 
+#include <ricpad/precision.hpp>
+#include <ricpad/thread_pool.hpp>
+
 #ifndef RICPAD_HANKDET
 #define RICPAD_HANKDET
 
@@ -51,5 +58,301 @@ T hankdet(
     return coefs[0];
 }
 
+// Storage for the levels of the Dodgson condensation, reused by successive 
+// calls to hankdet so that they do not allocate once it is large enough. The
+// numbers are created again when the working precision changes.
+template <class T>
+class Workspace {
+    private:
+        unsigned digits_ = 0;
+
+    public:
+        // Levels j-2, j-1 and j of the condensation
+        std::vector<T> m2, m1, m0;
+        // Scratch number
+        T t;
+        // log2 of the error bounds of levels j-2, j-1 and j, used by
+        // hankdet_error
+        std::vector<double> e2, e1, e0;
+
+        // Make room for levels of n elements
+        void reserve(const int n) {
+            const unsigned digits = precision<T>::get();
+
+            if ( digits != digits_ ) {
+                m2.clear();
+                m1.clear();
+                m0.clear();
+                t = T();
+                digits_ = digits;
+            }
+
+            if ( int(m0.size()) < n ) {
+                m2.resize(n);
+                m1.resize(n);
+                m0.resize(n);
+                e2.resize(n);
+                e1.resize(n);
+                e0.resize(n);
+            }
+        };
+};
+
+// Same as hankdet, but reading the coefficients from coefs[0]...coefs[2*D-2]
+// without modifying them, and keeping the levels in ws. coefs usually points
+// into a longer series, so that no copy of it is needed.
+template <class T>
+T hankdet(
+        const int D, 
+        // Coefficients f[d+1]...f[2*D+d-1]
+        const T* coefs,
+        Workspace<T>& ws
+        ) {
+    if ( D == 0 ) return 1;
+    if ( D == 1 ) return coefs[0];
+
+    ws.reserve(2*D-1);
+
+    // Level 2 divides by the ones of level 0
+    for ( int k = 0; k <= 2*(D-2); k++ ) {
+        ws.m0[k] = coefs[k]*coefs[k+2];
+        ws.t = coefs[k+1]*coefs[k+1];
+        ws.m0[k] -= ws.t;
+    }
+
+    for ( int j = 3; j <= D; j++ ) {
+        ws.m2.swap(ws.m1);
+        ws.m1.swap(ws.m0);
+
+        // Level j-2 is read from coefs when j == 3
+        const T* m2 = j == 3 ? coefs : ws.m2.data();
+
+        for ( int k = 0; k <= 2*(D-j); k++ ) {
+            ws.m0[k] = ws.m1[k]*ws.m1[k+2];
+            ws.t = ws.m1[k+1]*ws.m1[k+1];
+            ws.m0[k] -= ws.t;
+            ws.m0[k] /= m2[k+2];
+        }
+    }
+
+    return ws.m0[0];
+}
+
+namespace detail {
+// Exponent e of x, with 2^(e-1) <= |x| < 2^e
+inline long exponent(const double x) {
+    return std::ilogb(x) + 1;
+}
+
+inline long exponent(const boost::multiprecision::mpfr_float& x) {
+    return mpfr_get_exp(x.backend().data());
+}
+
+// log2(2^a + 2^b)
+inline double log2_sum(const double a, const double b) {
+    if ( a < b ) return log2_sum(b, a);
+    if ( b == -std::numeric_limits<double>::infinity() ) return a;
+
+    return a + std::log2(1 + std::exp2(b - a));
+}
+} // namespace detail
+
+// Same as hankdet with a workspace, also returning in log2_error a running
+// bound for the relative error of the result, in units of the roundoff of T
+// and on a log2 scale. Each coefficient is assumed to carry one unit of
+// roundoff. The bound follows the first order error of every product, 
+// difference and quotient of the condensation, so it grows with the 
+// cancellation in the differences; log2_error*log10(2) are the digits lost.
+// Only for real T.
+template <class T>
+T hankdet_error(
+        const int D, 
+        // Coefficients f[d+1]...f[2*D+d-1]
+        const T* coefs,
+        Workspace<T>& ws,
+        double& log2_error
+        ) {
+    using detail::exponent;
+    using detail::log2_sum;
+
+    log2_error = 0;
+    if ( D == 0 ) return 1;
+    if ( D == 1 ) return coefs[0];
+
+    ws.reserve(2*D-1);
+
+    const double infinity = std::numeric_limits<double>::infinity();
+    // Error bound of the difference m0[k] = a - b, where a and b have 
+    // exponents xa and xb (-infinity for zero) and error bounds ea and eb. 
+    // Exponents are compared so that no ratio of the numbers is needed.
+    auto difference = [&] (
+            int k, double xa, double ea, double xb, double eb) -> double {
+        if ( ws.m0[k] == 0 ) return infinity;
+
+        const double x = exponent(ws.m0[k]);
+        const double ta = xa == -infinity ? xa : xa - x + 1 + ea;
+        const double tb = xb == -infinity ? xb : xb - x + 1 + eb;
+        return log2_sum(log2_sum(ta, tb), 0);
+    };
+
+    for ( int k = 0; k <= 2*(D-2); k++ ) {
+        ws.m0[k] = coefs[k]*coefs[k+2];
+        ws.t = coefs[k+1]*coefs[k+1];
+        const double xa = ws.m0[k] == 0 ? -infinity : exponent(ws.m0[k]);
+        const double xb = ws.t == 0 ? -infinity : exponent(ws.t);
+        ws.m0[k] -= ws.t;
+
+        // Products of coefficients with one unit of error each
+        ws.e0[k] = difference(k, xa, std::log2(3.), xb, std::log2(3.));
+    }
+
+    for ( int j = 3; j <= D; j++ ) {
+        ws.m2.swap(ws.m1);
+        ws.m1.swap(ws.m0);
+        ws.e2.swap(ws.e1);
+        ws.e1.swap(ws.e0);
+
+        const T* m2 = j == 3 ? coefs : ws.m2.data();
+
+        for ( int k = 0; k <= 2*(D-j); k++ ) {
+            ws.m0[k] = ws.m1[k]*ws.m1[k+2];
+            ws.t = ws.m1[k+1]*ws.m1[k+1];
+            const double xa = ws.m0[k] == 0 ? -infinity : exponent(ws.m0[k]);
+            const double xb = ws.t == 0 ? -infinity : exponent(ws.t);
+            ws.m0[k] -= ws.t;
+
+            const double ea = log2_sum(log2_sum(ws.e1[k], ws.e1[k+2]), 0);
+            const double eb = log2_sum(1 + ws.e1[k+1], 0);
+            const double en = difference(k, xa, ea, xb, eb);
+
+            ws.m0[k] /= m2[k+2];
+            ws.e0[k] = log2_sum(log2_sum(en, j == 3 ? 0 : ws.e2[k+2]), 0);
+        }
+    }
+
+    log2_error = ws.e0[0];
+    return ws.m0[0];
+}
+
+// Same as hankdet, but each level of the condensation is split among the 
+// threads of pool, with a barrier between levels. Determinants with D < Dserial
+// and levels too short to be worth splitting are computed serially.
+template <class T>
+T hankdet(
+        const int D, 
+        // Coefficients f[d+1]...f[2*D+d-1]. This vector is destroyed.
+        std::vector<T>& coefs,
+        ThreadPool& pool,
+        const int Dserial = 32
+        ) {
+    using std::vector;
+
+    // Minimum number of entries handled by each thread
+    const int min_chunk = 8;
+
+    vector<T> coefsm1, coefsm2;
+    vector<std::future<void>> tasks;
+    static const char* function = "ricpad::hankdet::hankdet<%1%>";
+
+    if ( int(coefs.size()) < 2*D-1 ) {
+        return boost::math::policies::raise_evaluation_error(
+            function,
+            "Input vector coefs should contain at least %1% elements. ", 
+            2*D-1,
+            boost::math::policies::policy<>());
+    }
+
+    if ( D < Dserial || pool.size() < 2 ) return hankdet(D, coefs);
+
+    // The workers compute with the precision of the calling thread
+    const unsigned digits = precision<T>::get();
+
+    coefsm1 = std::vector<T>(2*D, T(1));
+
+    for ( int j = 2; j <= D; j++ ) {
+        coefsm2 = (vector<T>&&)(coefsm1);
+        coefsm1 = (vector<T>&&)(coefs);
+
+        const int n = 2*(D-j) + 1;
+        const int nchunks = std::min(pool.size(), n/min_chunk);
+
+        coefs.resize(n);
+
+        auto level = [&coefs, &coefsm1, &coefsm2] (int kmin, int kmax) {
+            for ( int k = kmin; k < kmax; k++ ) {
+                coefs[k] = 
+                    (coefsm1[k]*coefsm1[k+2] - coefsm1[k+1]*coefsm1[k+1]) /
+                    coefsm2[k+2];
+            }
+        };
+
+        if ( nchunks < 2 ) {
+            level(0, n);
+            continue;
+        }
+
+        tasks.clear();
+        for ( int c = 0; c < nchunks; c++ ) {
+            const int kmin = (c*n)/nchunks, kmax = ((c+1)*n)/nchunks;
+            tasks.push_back(pool.submit([&level, kmin, kmax, digits] {
+                precision<T>::set(digits);
+                level(kmin, kmax);
+            }));
+        }
+        for ( auto& t : tasks ) t.get();
+    }
+
+    return coefs[0];
+}
+
+// Return the hankel determinants H_D for D = Dmin...Dmax from a single 
+// condensation of size Dmax. Each level j of the condensation starts with the 
+// leading minor H_j, so all of them come at the cost of H_Dmax alone.
+template <class T>
+std::vector<T> hankdets(
+        const int Dmin,
+        const int Dmax,
+        // Coefficients f[d+1]...f[2*Dmax+d-1]. This vector is destroyed.
+        std::vector<T>& coefs
+        ) {
+    using std::vector;
+
+    vector<T> coefsm1, coefsm2, dets;
+    static const char* function = "ricpad::hankdet::hankdets<%1%>";
+
+    // Check if we have enough coefficients
+    if ( int(coefs.size()) < 2*Dmax-1 ) {
+        boost::math::policies::raise_evaluation_error(
+            function,
+            "Input vector coefs should contain at least %1% elements. ", 
+            2*Dmax-1,
+            boost::math::policies::policy<>());
+        return dets;
+    }
+
+    if ( Dmin <= 0 ) dets.push_back(T(1));
+    if ( Dmax <= 0 ) return dets;
+    if ( Dmin <= 1 ) dets.push_back(coefs[0]);
+
+    coefsm1 = std::vector<T>(2*Dmax, T(1));
+
+    for ( int j = 2; j <= Dmax; j++ ) {
+        coefsm2 = (vector<T>&&)(coefsm1);
+        coefsm1 = (vector<T>&&)(coefs);
+
+        for ( int k = 0; k <= 2*(Dmax-j); k++ ) {
+            coefs.emplace_back(
+                    (coefsm1[k]*coefsm1[k+2] - 
+                    coefsm1[k+1]*coefsm1[k+1]) /
+                    coefsm2[k+2]
+                    );
+        }
+
+        if ( j >= Dmin ) dets.push_back(coefs[0]);
+    }
+
+    return dets;
+}
+
 } // namespace
 #endif
@@ -0,0 +1,293 @@
+#include <string>
+#include <ostream>
+#include <utility>
+#include <type_traits>
+#include <boost/multiprecision/mpfr.hpp>
+#include <boost/math/policies/error_handling.hpp>
+
+#include <ricpad/precision.hpp>
+
+#ifndef RICPAD_INTERVAL
+#define RICPAD_INTERVAL
+
+namespace ricpad {
+
+namespace detail {
+// Built-in numbers rounded in the direction rnd into an MPFR number
+template <class U>
+typename std::enable_if<std::is_integral<U>::value &&
+    std::is_signed<U>::value>::type
+set_rounded(mpfr_ptr y, const U x, const mpfr_rnd_t rnd) {
+    mpfr_set_si(y, long(x), rnd);
+}
+
+template <class U>
+typename std::enable_if<std::is_integral<U>::value &&
+    ! std::is_signed<U>::value>::type
+set_rounded(mpfr_ptr y, const U x, const mpfr_rnd_t rnd) {
+    mpfr_set_ui(y, (unsigned long)(x), rnd);
+}
+
+template <class U>
+typename std::enable_if<std::is_floating_point<U>::value>::type
+set_rounded(mpfr_ptr y, const U x, const mpfr_rnd_t rnd) {
+    mpfr_set_ld(y, x, rnd);
+}
+} // namespace detail
+
+// Closed interval [lo, hi] with MPFR endpoints, for computations whose
+// result must be rigorous. Every operation rounds the lower endpoint down
+// and the upper one up, so that the exact result of the operation on any
+// numbers of the operands lies in the result. The endpoints have the
+// default precision of mpfr_float when the interval is created, which is
+// also the one of its results.
+//
+// Only the operations of the series and of the Dodgson condensation are
+// provided. Division by an interval that contains zero raises
+// boost::math::evaluation_error.
+class interval {
+    private:
+        typedef boost::multiprecision::mpfr_float mpfr_float;
+
+        mpfr_float lo_, hi_;
+
+        mpfr_ptr lo() {return lo_.backend().data();};
+        mpfr_ptr hi() {return hi_.backend().data();};
+        mpfr_srcptr lo() const {return lo_.backend().data();};
+        mpfr_srcptr hi() const {return hi_.backend().data();};
+
+        static void division_by_zero() {
+            boost::math::policies::raise_evaluation_error(
+                "ricpad::interval::operator/=",
+                "Division by an interval that contains %1%. ",
+                0,
+                boost::math::policies::policy<>());
+        };
+
+    public:
+        //----------------------------------------------------------------------
+        // Constructors
+        interval() : lo_(0), hi_(0) {};
+
+        // The smallest interval that holds x
+        interval(const mpfr_float& x) {
+            mpfr_set(lo(), x.backend().data(), MPFR_RNDD);
+            mpfr_set(hi(), x.backend().data(), MPFR_RNDU);
+        };
+
+        // The smallest interval that holds [a, b]
+        interval(const mpfr_float& a, const mpfr_float& b) {
+            mpfr_set(lo(), a.backend().data(), MPFR_RNDD);
+            mpfr_set(hi(), b.backend().data(), MPFR_RNDU);
+        };
+
+        // Constants from built-in numbers, e.g. num_t(1) or return 1
+        template <typename U, typename = typename std::enable_if<
+            std::is_arithmetic<U>::value>::type>
+        interval(U x) {
+            detail::set_rounded(lo(), x, MPFR_RNDD);
+            detail::set_rounded(hi(), x, MPFR_RNDU);
+        };
+
+        //----------------------------------------------------------------------
+        // Getters
+        const mpfr_float& lower() const {return lo_;};
+        const mpfr_float& upper() const {return hi_;};
+
+        // Midpoint, rounded to nearest, which need not lie exactly halfway
+        mpfr_float midpoint() const {
+            mpfr_float m;
+            mpfr_ptr pm = m.backend().data();
+            mpfr_add(pm, lo(), hi(), MPFR_RNDN);
+            mpfr_div_2ui(pm, pm, 1, MPFR_RNDN);
+            return m;
+        };
+
+        // Upper bound of hi - lo
+        mpfr_float width() const {
+            mpfr_float w;
+            mpfr_sub(w.backend().data(), hi(), lo(), MPFR_RNDU);
+            return w;
+        };
+
+        bool contains(const mpfr_float& x) const {
+            return lo_ <= x && x <= hi_;
+        };
+
+        bool contains_zero() const {return lo_ <= 0 && hi_ >= 0;};
+
+        // Whether this interval lies in the interior of b
+        bool interior(const interval& b) const {
+            return b.lo_ < lo_ && hi_ < b.hi_;
+        };
+
+        // Change the precision of the endpoints, rounding them outwards
+        void precision(const unsigned digits) {
+            mpfr_float a(0, digits), b(0, digits);
+            mpfr_set(a.backend().data(), lo(), MPFR_RNDD);
+            mpfr_set(b.backend().data(), hi(), MPFR_RNDU);
+            lo_.swap(a);
+            hi_.swap(b);
+        };
+
+        // The endpoints in scientific notation with digits digits after the
+        // point, also rounded outwards
+        std::string str(const int digits) const {
+            char *a, *b;
+            mpfr_asprintf(&a, "%.*RDe", digits, lo());
+            mpfr_asprintf(&b, "%.*RUe", digits, hi());
+            std::string s = std::string("[") + a + ", " + b + "]";
+            mpfr_free_str(a);
+            mpfr_free_str(b);
+            return s;
+        };
+
+        //----------------------------------------------------------------------
+        // Arithmetic. The operands may be the same interval.
+        interval& operator+=(const interval& b) {
+            mpfr_add(lo(), lo(), b.lo(), MPFR_RNDD);
+            mpfr_add(hi(), hi(), b.hi(), MPFR_RNDU);
+            return *this;
+        };
+
+        interval& operator-=(const interval& b) {
+            if ( &b == this ) return *this -= interval(b);
+            mpfr_sub(lo(), lo(), b.hi(), MPFR_RNDD);
+            mpfr_sub(hi(), hi(), b.lo(), MPFR_RNDU);
+            return *this;
+        };
+
+        // The endpoints of the product are the products of the endpoints
+        // selected by their signs; only when both intervals contain zero
+        // are two candidates compared for each.
+        interval& operator*=(const interval& b) {
+            const interval& a = *this;
+            mpfr_float l, h;
+            mpfr_ptr pl = l.backend().data(), ph = h.backend().data();
+
+            if ( mpfr_sgn(a.lo()) >= 0 ) {
+                if ( mpfr_sgn(b.lo()) >= 0 ) {
+                    mpfr_mul(pl, a.lo(), b.lo(), MPFR_RNDD);
+                    mpfr_mul(ph, a.hi(), b.hi(), MPFR_RNDU);
+                } else if ( mpfr_sgn(b.hi()) <= 0 ) {
+                    mpfr_mul(pl, a.hi(), b.lo(), MPFR_RNDD);
+                    mpfr_mul(ph, a.lo(), b.hi(), MPFR_RNDU);
+                } else {
+                    mpfr_mul(pl, a.hi(), b.lo(), MPFR_RNDD);
+                    mpfr_mul(ph, a.hi(), b.hi(), MPFR_RNDU);
+                }
+            } else if ( mpfr_sgn(a.hi()) <= 0 ) {
+                if ( mpfr_sgn(b.lo()) >= 0 ) {
+                    mpfr_mul(pl, a.lo(), b.hi(), MPFR_RNDD);
+                    mpfr_mul(ph, a.hi(), b.lo(), MPFR_RNDU);
+                } else if ( mpfr_sgn(b.hi()) <= 0 ) {
+                    mpfr_mul(pl, a.hi(), b.hi(), MPFR_RNDD);
+                    mpfr_mul(ph, a.lo(), b.lo(), MPFR_RNDU);
+                } else {
+                    mpfr_mul(pl, a.lo(), b.hi(), MPFR_RNDD);
+                    mpfr_mul(ph, a.lo(), b.lo(), MPFR_RNDU);
+                }
+            } else {
+                if ( mpfr_sgn(b.lo()) >= 0 ) {
+                    mpfr_mul(pl, a.lo(), b.hi(), MPFR_RNDD);
+                    mpfr_mul(ph, a.hi(), b.hi(), MPFR_RNDU);
+                } else if ( mpfr_sgn(b.hi()) <= 0 ) {
+                    mpfr_mul(pl, a.hi(), b.lo(), MPFR_RNDD);
+                    mpfr_mul(ph, a.lo(), b.lo(), MPFR_RNDU);
+                } else {
+                    mpfr_float t;
+                    mpfr_ptr pt = t.backend().data();
+                    mpfr_mul(pl, a.lo(), b.hi(), MPFR_RNDD);
+                    mpfr_mul(pt, a.hi(), b.lo(), MPFR_RNDD);
+                    mpfr_min(pl, pl, pt, MPFR_RNDD);
+                    mpfr_mul(ph, a.lo(), b.lo(), MPFR_RNDU);
+                    mpfr_mul(pt, a.hi(), b.hi(), MPFR_RNDU);
+                    mpfr_max(ph, ph, pt, MPFR_RNDU);
+                }
+            }
+
+            lo_.swap(l);
+            hi_.swap(h);
+            return *this;
+        };
+
+        // a/b = a*(1/b)
+        interval& operator/=(const interval& b) {
+            if ( b.contains_zero() ) division_by_zero();
+
+            interval r;
+            mpfr_ui_div(r.lo(), 1, b.hi(), MPFR_RNDD);
+            mpfr_ui_div(r.hi(), 1, b.lo(), MPFR_RNDU);
+            return *this *= r;
+        };
+
+        // Scaling by integers, whose sign decides which endpoint is which
+        interval& operator*=(const long b) {
+            if ( b < 0 ) lo_.swap(hi_);
+            mpfr_mul_si(lo(), lo(), b, MPFR_RNDD);
+            mpfr_mul_si(hi(), hi(), b, MPFR_RNDU);
+            return *this;
+        };
+
+        interval& operator/=(const long b) {
+            if ( b == 0 ) division_by_zero();
+            if ( b < 0 ) lo_.swap(hi_);
+            mpfr_div_si(lo(), lo(), b, MPFR_RNDD);
+            mpfr_div_si(hi(), hi(), b, MPFR_RNDU);
+            return *this;
+        };
+
+        interval& operator*=(const int b) {return *this *= long(b);};
+        interval& operator/=(const int b) {return *this /= long(b);};
+
+        interval operator-() const {
+            interval r;
+            mpfr_neg(r.lo(), hi(), MPFR_RNDD);
+            mpfr_neg(r.hi(), lo(), MPFR_RNDU);
+            return r;
+        };
+
+        //----------------------------------------------------------------------
+        // Same endpoints. This compares the intervals as objects, e.g. to
+        // reuse a series computed at the same point, and not the numbers in
+        // them.
+        bool operator==(const interval& b) const {
+            return lo_ == b.lo_ && hi_ == b.hi_;
+        };
+        bool operator!=(const interval& b) const {return ! (*this == b);};
+};
+
+//------------------------------------------------------------------------------
+// Binary operators
+inline interval operator+(interval a, const interval& b) {return a += b;}
+inline interval operator-(interval a, const interval& b) {return a -= b;}
+inline interval operator*(interval a, const interval& b) {return a *= b;}
+inline interval operator/(interval a, const interval& b) {return a /= b;}
+
+inline interval operator*(interval a, const int b) {return a *= b;}
+inline interval operator*(const int a, interval b) {return b *= a;}
+inline interval operator/(interval a, const int b) {return a /= b;}
+
+// Intersection of a and b, stored in c. Returns false if it is empty.
+inline bool intersect(const interval& a, const interval& b, interval& c) {
+    const auto& lo = a.lower() > b.lower() ? a.lower() : b.lower();
+    const auto& hi = a.upper() < b.upper() ? a.upper() : b.upper();
+    if ( lo > hi ) return false;
+
+    c = interval(lo, hi);
+    return true;
+}
+
+inline std::ostream& operator<<(std::ostream& os, const interval& a) {
+    return os << a.str(int(os.precision()));
+}
+
+// The endpoints work with the precision of mpfr_float
+template <>
+struct precision<interval> :
+    public precision<boost::multiprecision::mpfr_float> {
+    static void apply(interval& x, unsigned digits) {x.precision(digits);};
+};
+
+} // namespace
+#endif
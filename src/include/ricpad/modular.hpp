@@ -0,0 +1,169 @@
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <boost/multiprecision/gmp.hpp>
+
+#ifndef RICPAD_MODULAR
+#define RICPAD_MODULAR
+
+namespace ricpad::modular {
+
+// Arithmetic modulo primes p < 2^31, so that the product of two residues
+// fits in a word, and the reconstruction of integers and rationals from their
+// residues modulo several primes.
+typedef std::uint64_t word;
+typedef boost::multiprecision::mpz_int int_t;
+
+inline word add(const word a, const word b, const word p) {
+    const word s = a + b;
+    return s >= p ? s - p : s;
+}
+
+inline word sub(const word a, const word b, const word p) {
+    return a >= b ? a - b : a + p - b;
+}
+
+inline word mul(const word a, const word b, const word p) {
+    return a*b % p;
+}
+
+inline word power(word a, word e, const word p) {
+    word r = 1;
+    for ( ; e > 0; e >>= 1 ) {
+        if ( e & 1 ) r = mul(r, a, p);
+        a = mul(a, a, p);
+    }
+
+    return r;
+}
+
+// Inverse of a != 0 modulo the prime p
+inline word inverse(const word a, const word p) {
+    return power(a, p-2, p);
+}
+
+// Residue of the integer c
+inline word reduce(const long c, const word p) {
+    const long r = c % long(p);
+    return r < 0 ? word(r + long(p)) : word(r);
+}
+
+inline word reduce(const int_t& c, const word p) {
+    const word r = mpz_fdiv_ui(c.backend().data(), p);
+    return r;
+}
+
+// Largest prime below n, by trial division
+inline word prime_before(word n) {
+    while ( --n > 2 ) {
+        bool prime = n % 2 != 0;
+        for ( word k = 3; prime && k*k <= n; k += 2 )
+            if ( n % k == 0 ) prime = false;
+        if ( prime ) return n;
+    }
+
+    return 2;
+}
+
+//------------------------------------------------------------------------------
+// Hankel determinant of c[0]...c[2*D-2] modulo p, by Gaussian elimination on
+// the explicit matrix. Over the integers modulo a prime every division is
+// exact, so no fraction-free scheme is needed. a is scratch storage.
+inline word hankdet(
+        const int D, const word* c, const word p, std::vector<word>& a
+        ) {
+    a.resize(D*D);
+    for ( int i = 0; i < D; i++ )
+        for ( int j = 0; j < D; j++ )
+            a[i*D+j] = c[i+j];
+
+    word det = 1;
+
+    for ( int k = 0; k < D; k++ ) {
+        int r = k;
+        while ( r < D && a[r*D+k] == 0 ) r++;
+        if ( r == D ) return 0;
+
+        if ( r != k ) {
+            for ( int j = k; j < D; j++ ) std::swap(a[r*D+j], a[k*D+j]);
+            det = p - det;
+        }
+
+        const word pivot = a[k*D+k], inv = inverse(pivot, p);
+        det = mul(det, pivot, p);
+
+        for ( int i = k+1; i < D; i++ ) {
+            const word m = mul(a[i*D+k], inv, p);
+            if ( m == 0 ) continue;
+            for ( int j = k+1; j < D; j++ )
+                a[i*D+j] = sub(a[i*D+j], mul(m, a[k*D+j], p), p);
+        }
+    }
+
+    return det;
+}
+
+// Coefficients, lowest degree first, of the polynomial of degree below n
+// that takes the values y[0]...y[n-1] at 0...n-1 modulo p, with n < p. The
+// divided differences of Newton's form are converted to powers of x.
+inline std::vector<word> interpolate(std::vector<word> y, const word p) {
+    const int n = y.size();
+
+    std::vector<word> inverses(n, 1);
+    for ( int k = 1; k < n; k++ ) inverses[k] = inverse(k, p);
+
+    // y[k] becomes the divided difference [y_0,...,y_k]
+    for ( int k = 1; k < n; k++ )
+        for ( int i = n-1; i >= k; i-- )
+            y[i] = mul(sub(y[i], y[i-1], p), inverses[k], p);
+
+    // Horner scheme on the nested form y[0] + (x-0)*(y[1] + (x-1)*(...))
+    std::vector<word> c(n, 0);
+    for ( int k = n-1; k >= 0; k-- ) {
+        // c = c*(x - k) + y[k]
+        for ( int i = n-1; i > 0; i-- )
+            c[i] = sub(c[i-1], mul(c[i], word(k), p), p);
+        c[0] = add(mul(p - word(k) % p, c[0], p), y[k], p);
+    }
+
+    return c;
+}
+
+//------------------------------------------------------------------------------
+// Chinese remaindering: x, known modulo m, is made to be r modulo p as well,
+// where minv is the inverse of m modulo p. The caller multiplies m by p
+// afterwards. x stays in [0, m*p).
+inline void crt(
+        int_t& x, const int_t& m, const word r, const word p, const word minv
+        ) {
+    const word t = mul(sub(r, reduce(x, p), p), minv, p);
+    mpz_addmul_ui(x.backend().data(), m.backend().data(), t);
+}
+
+// Rational reconstruction: the fraction n/d with |n|, d <= sqrt(m/2) that is
+// congruent to x modulo m, found with the extended Euclidean algorithm.
+// Returns false if there is none.
+inline bool rational(const int_t& x, const int_t& m, int_t& n, int_t& d) {
+    const int_t bound = sqrt(int_t(m/2));
+
+    int_t r0 = m, r1 = x, s0 = 0, s1 = 1, q, t;
+    while ( r1 > bound ) {
+        q = r0/r1;
+        t = r0 - q*r1;
+        r0 = std::move(r1);
+        r1 = std::move(t);
+        t = s0 - q*s1;
+        s0 = std::move(s1);
+        s1 = std::move(t);
+    }
+
+    if ( s1 == 0 || abs(s1) > bound || gcd(r1, s1) != 1 ) return false;
+
+    n = s1 < 0 ? int_t(-r1) : r1;
+    d = abs(s1);
+
+    return true;
+}
+
+} // namespace
+#endif
@@ -0,0 +1,640 @@
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+#include <boost/multiprecision/mpfr.hpp>
+
+#include <solver/dual.hpp>
+
+#ifndef RICPAD_MULTI_DOUBLE
+#define RICPAD_MULTI_DOUBLE
+
+namespace ricpad {
+
+namespace detail {
+// Error-free transformations of doubles: each returns the rounded result and
+// leaves its rounding error in e.
+
+// s + e = a + b, assuming |a| >= |b|
+inline double quick_two_sum(const double a, const double b, double& e) {
+    const double s = a + b;
+    e = b - (s - a);
+    return s;
+}
+
+// s + e = a + b
+inline double two_sum(const double a, const double b, double& e) {
+    const double s = a + b;
+    const double bb = s - a;
+    e = (a - (s - bb)) + (b - bb);
+    return s;
+}
+
+// p + e = a*b
+inline double two_prod(const double a, const double b, double& e) {
+    const double p = a*b;
+#ifdef FP_FAST_FMA
+    e = std::fma(a, b, -p);
+#else
+    // Dekker's product, splitting each factor in two halves of 26 bits
+    const double split = 134217729.0;
+    double t = split*a;
+    const double ahi = t - (t - a), alo = a - ahi;
+    t = split*b;
+    const double bhi = t - (t - b), blo = b - bhi;
+    e = ((ahi*bhi - p) + ahi*blo + alo*bhi) + alo*blo;
+#endif
+    return p;
+}
+
+// a + b + c, left as the nonoverlapping a + b + c
+inline void three_sum(double& a, double& b, double& c) {
+    double t1, t2, t3;
+    t1 = two_sum(a, b, t2);
+    a = two_sum(c, t1, t3);
+    b = two_sum(t2, t3, c);
+}
+
+// a + b + c, left as a + b up to an error of the order of c
+inline void three_sum2(double& a, double& b, const double c) {
+    double t1, t2, t3;
+    t1 = two_sum(a, b, t2);
+    a = two_sum(c, t1, t3);
+    b = t2 + t3;
+}
+
+// Turn c0 + c1 + c2 + c3 + c4, with c0 the largest, into the nonoverlapping
+// c0 + c1 + c2 + c3
+inline void renorm(
+        double& c0, double& c1, double& c2, double& c3, double c4 = 0
+        ) {
+    double s0, s1, s2 = 0, s3 = 0;
+
+    if ( std::isinf(c0) ) return;
+
+    s0 = quick_two_sum(c3, c4, c4);
+    s0 = quick_two_sum(c2, s0, c3);
+    s0 = quick_two_sum(c1, s0, c2);
+    c0 = quick_two_sum(c0, s0, c1);
+
+    s0 = c0;
+    s1 = c1;
+
+    // Pack the nonzero terms from the top
+    if ( s1 != 0 ) {
+        s1 = quick_two_sum(s1, c2, s2);
+        if ( s2 != 0 ) {
+            s2 = quick_two_sum(s2, c3, s3);
+            if ( s3 != 0 ) s3 += c4;
+            else s2 = quick_two_sum(s2, c4, s3);
+        } else {
+            s1 = quick_two_sum(s1, c3, s2);
+            if ( s2 != 0 ) s2 = quick_two_sum(s2, c4, s3);
+            else s1 = quick_two_sum(s1, c4, s2);
+        }
+    } else {
+        s0 = quick_two_sum(s0, c2, s1);
+        if ( s1 != 0 ) {
+            s1 = quick_two_sum(s1, c3, s2);
+            if ( s2 != 0 ) s2 = quick_two_sum(s2, c4, s3);
+            else s1 = quick_two_sum(s1, c4, s2);
+        } else {
+            s0 = quick_two_sum(s0, c3, s1);
+            if ( s1 != 0 ) s1 = quick_two_sum(s1, c4, s2);
+            else s0 = quick_two_sum(s0, c4, s1);
+        }
+    }
+
+    c0 = s0;
+    c1 = s1;
+    c2 = s2;
+    c3 = s3;
+}
+
+} // namespace detail
+
+//------------------------------------------------------------------------------
+// Number represented as the unevaluated sum of N doubles of decreasing
+// magnitude that do not overlap, following the double-double and quad-double
+// arithmetic of Hida, Li and Bailey. N = 2 gives about 31 digits and N = 4
+// about 62, over the exponent range of double. Arithmetic is done with
+// error-free transformations on plain doubles, so no number allocates and
+// the compiler can keep them in registers.
+template <int N>
+class multi_double {
+    private:
+        // Components, largest first
+        double x_[N];
+
+    public:
+        //----------------------------------------------------------------------
+        // Constructors
+        multi_double() : x_() {};
+
+        // Constants from built-in numbers, e.g. num_t(1) or return 1
+        template <typename U, typename = typename std::enable_if<
+            std::is_arithmetic<U>::value>::type>
+        multi_double(U v) : x_() {x_[0] = double(v);};
+
+        // From components that are already normalized
+        explicit multi_double(const double* x) {
+            for ( int k = 0; k < N; k++ ) x_[k] = x[k];
+        };
+
+        // Nearest to the MPFR number x
+        explicit multi_double(mpfr_srcptr x) : x_() {
+            mpfr_t r;
+            mpfr_init2(r, mpfr_get_prec(x) + 53);
+            mpfr_set(r, x, MPFR_RNDN);
+
+            for ( int k = 0; k < N && ! mpfr_zero_p(r); k++ ) {
+                x_[k] = mpfr_get_d(r, MPFR_RNDN);
+                if ( ! std::isfinite(x_[k]) ) break;
+                mpfr_sub_d(r, r, x_[k], MPFR_RNDN);
+            }
+
+            mpfr_clear(r);
+        };
+
+        //----------------------------------------------------------------------
+        // Getters
+        double operator[](const int k) const {return x_[k];};
+        explicit operator double() const {return x_[0];};
+
+        // Store the number in y, rounded to its precision
+        void get(mpfr_ptr y) const {
+            mpfr_t r;
+            mpfr_init2(r, mpfr_get_prec(y) + 64);
+            mpfr_set_d(r, x_[N-1], MPFR_RNDN);
+            for ( int k = N-2; k >= 0; k-- ) mpfr_add_d(r, r, x_[k], MPFR_RNDN);
+            mpfr_set(y, r, MPFR_RNDN);
+            mpfr_clear(r);
+        };
+
+        //----------------------------------------------------------------------
+        // Arithmetic
+        multi_double& operator+=(const multi_double& b);
+        multi_double& operator*=(const multi_double& b);
+        multi_double& operator/=(const multi_double& b);
+        // Product by a double, cheaper than by a multi_double
+        multi_double& mul(const double b);
+
+        multi_double& operator-=(const multi_double& b) {
+            return *this += -b;
+        };
+
+        template <typename U, typename = typename std::enable_if<
+            std::is_arithmetic<U>::value>::type>
+        multi_double& operator+=(U b) {return *this += multi_double(b);};
+
+        template <typename U, typename = typename std::enable_if<
+            std::is_arithmetic<U>::value>::type>
+        multi_double& operator-=(U b) {return *this -= multi_double(b);};
+
+        template <typename U, typename = typename std::enable_if<
+            std::is_arithmetic<U>::value>::type>
+        multi_double& operator*=(U b) {return mul(double(b));};
+
+        template <typename U, typename = typename std::enable_if<
+            std::is_arithmetic<U>::value>::type>
+        multi_double& operator/=(U b) {return *this /= multi_double(b);};
+
+        multi_double operator-() const {
+            multi_double y;
+            for ( int k = 0; k < N; k++ ) y.x_[k] = -x_[k];
+            return y;
+        };
+};
+
+typedef multi_double<2> dd_real;
+typedef multi_double<4> qd_real;
+
+//------------------------------------------------------------------------------
+// Double-double
+template <>
+inline dd_real& dd_real::operator+=(const dd_real& b) {
+    using namespace detail;
+    double s1, s2, t1, t2;
+
+    s1 = two_sum(x_[0], b.x_[0], s2);
+    t1 = two_sum(x_[1], b.x_[1], t2);
+    s2 += t1;
+    s1 = quick_two_sum(s1, s2, s2);
+    s2 += t2;
+    x_[0] = quick_two_sum(s1, s2, x_[1]);
+
+    return *this;
+}
+
+template <>
+inline dd_real& dd_real::operator*=(const dd_real& b) {
+    using namespace detail;
+    double p1, p2;
+
+    p1 = two_prod(x_[0], b.x_[0], p2);
+    p2 += x_[0]*b.x_[1] + x_[1]*b.x_[0];
+    x_[0] = quick_two_sum(p1, p2, x_[1]);
+
+    return *this;
+}
+
+template <>
+inline dd_real& dd_real::mul(const double b) {
+    using namespace detail;
+    double p1, p2;
+
+    p1 = two_prod(x_[0], b, p2);
+    p2 += x_[1]*b;
+    x_[0] = quick_two_sum(p1, p2, x_[1]);
+
+    return *this;
+}
+
+template <>
+inline dd_real& dd_real::operator/=(const dd_real& b) {
+    using namespace detail;
+    double q1, q2, q3;
+
+    q1 = x_[0]/b.x_[0];
+    dd_real r = *this;
+    r -= dd_real(b).mul(q1);
+
+    q2 = r.x_[0]/b.x_[0];
+    r -= dd_real(b).mul(q2);
+
+    q3 = r.x_[0]/b.x_[0];
+
+    q1 = quick_two_sum(q1, q2, q2);
+    x_[0] = q1;
+    x_[1] = q2;
+
+    return *this += q3;
+}
+
+//------------------------------------------------------------------------------
+// Quad-double
+// Added component by component, as the default addition of Hida, Li and
+// Bailey. It has no branches, and its error is bounded by the roundoff of 
+// the larger of the two terms rather than of the sum, which in a difference
+// is not larger than the error the terms already carry.
+template <>
+inline qd_real& qd_real::operator+=(const qd_real& b) {
+    using namespace detail;
+    double s0, s1, s2, s3, t0, t1, t2, t3;
+
+    s0 = two_sum(x_[0], b.x_[0], t0);
+    s1 = two_sum(x_[1], b.x_[1], t1);
+    s2 = two_sum(x_[2], b.x_[2], t2);
+    s3 = two_sum(x_[3], b.x_[3], t3);
+
+    s1 = two_sum(s1, t0, t0);
+    three_sum(s2, t0, t1);
+    three_sum2(s3, t0, t2);
+    t0 = t0 + t1 + t3;
+
+    renorm(s0, s1, s2, s3, t0);
+    x_[0] = s0;
+    x_[1] = s1;
+    x_[2] = s2;
+    x_[3] = s3;
+
+    return *this;
+}
+
+template <>
+inline qd_real& qd_real::operator*=(const qd_real& b) {
+    using namespace detail;
+    const double* a = x_;
+    const double* c = b.x_;
+    double p0, p1, p2, p3, p4, p5;
+    double q0, q1, q2, q3, q4, q5;
+    double s0, s1, s2, t0, t1;
+
+    p0 = two_prod(a[0], c[0], q0);
+    p1 = two_prod(a[0], c[1], q1);
+    p2 = two_prod(a[1], c[0], q2);
+    p3 = two_prod(a[0], c[2], q3);
+    p4 = two_prod(a[1], c[1], q4);
+    p5 = two_prod(a[2], c[0], q5);
+
+    three_sum(p1, p2, q0);
+
+    // (s0, s1, s2) = (p2, q1, q2) + (p3, p4, p5)
+    three_sum(p2, q1, q2);
+    three_sum(p3, p4, p5);
+    s0 = two_sum(p2, p3, t0);
+    s1 = two_sum(q1, p4, t1);
+    s2 = q2 + p5;
+    s1 = two_sum(s1, t0, t0);
+    s2 += t0 + t1;
+
+    // Terms of the order of the roundoff squared
+    s1 += a[0]*c[3] + a[1]*c[2] + a[2]*c[1] + a[3]*c[0] + q0 + q3 + q4 + q5;
+
+    renorm(p0, p1, s0, s1, s2);
+    x_[0] = p0;
+    x_[1] = p1;
+    x_[2] = s0;
+    x_[3] = s1;
+
+    return *this;
+}
+
+template <>
+inline qd_real& qd_real::mul(const double b) {
+    using namespace detail;
+    double p0, p1, p2, p3, q0, q1, q2, s0, s1, s2, s3, s4;
+
+    p0 = two_prod(x_[0], b, q0);
+    p1 = two_prod(x_[1], b, q1);
+    p2 = two_prod(x_[2], b, q2);
+    p3 = x_[3]*b;
+
+    s0 = p0;
+    s1 = two_sum(q0, p1, s2);
+    three_sum(s2, q1, p2);
+    three_sum2(q1, q2, p3);
+    s3 = q1;
+    s4 = q2 + p2;
+
+    renorm(s0, s1, s2, s3, s4);
+    x_[0] = s0;
+    x_[1] = s1;
+    x_[2] = s2;
+    x_[3] = s3;
+
+    return *this;
+}
+
+template <>
+inline qd_real& qd_real::operator/=(const qd_real& b) {
+    double q[4];
+    qd_real r = *this;
+
+    // Long division, one double of the quotient at a time
+    for ( int k = 0; k < 4; k++ ) {
+        q[k] = r.x_[0]/b.x_[0];
+        if ( k < 3 ) r -= qd_real(b).mul(q[k]);
+    }
+
+    detail::renorm(q[0], q[1], q[2], q[3]);
+    for ( int k = 0; k < 4; k++ ) x_[k] = q[k];
+
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+// Binary operators, with built-in numbers accepted on either side
+template <int N>
+multi_double<N> operator+(multi_double<N> a, const multi_double<N>& b) {
+    return a += b;
+}
+template <int N>
+multi_double<N> operator-(multi_double<N> a, const multi_double<N>& b) {
+    return a -= b;
+}
+template <int N>
+multi_double<N> operator*(multi_double<N> a, const multi_double<N>& b) {
+    return a *= b;
+}
+template <int N>
+multi_double<N> operator/(multi_double<N> a, const multi_double<N>& b) {
+    return a /= b;
+}
+
+template <int N, typename U, typename = typename std::enable_if<
+    std::is_arithmetic<U>::value>::type>
+multi_double<N> operator+(multi_double<N> a, U b) {return a += b;}
+template <int N, typename U, typename = typename std::enable_if<
+    std::is_arithmetic<U>::value>::type>
+multi_double<N> operator+(U a, multi_double<N> b) {return b += a;}
+template <int N, typename U, typename = typename std::enable_if<
+    std::is_arithmetic<U>::value>::type>
+multi_double<N> operator-(multi_double<N> a, U b) {return a -= b;}
+template <int N, typename U, typename = typename std::enable_if<
+    std::is_arithmetic<U>::value>::type>
+multi_double<N> operator-(U a, const multi_double<N>& b) {
+    return multi_double<N>(a) -= b;
+}
+template <int N, typename U, typename = typename std::enable_if<
+    std::is_arithmetic<U>::value>::type>
+multi_double<N> operator*(multi_double<N> a, U b) {return a *= b;}
+template <int N, typename U, typename = typename std::enable_if<
+    std::is_arithmetic<U>::value>::type>
+multi_double<N> operator*(U a, multi_double<N> b) {return b *= a;}
+template <int N, typename U, typename = typename std::enable_if<
+    std::is_arithmetic<U>::value>::type>
+multi_double<N> operator/(multi_double<N> a, U b) {return a /= b;}
+template <int N, typename U, typename = typename std::enable_if<
+    std::is_arithmetic<U>::value>::type>
+multi_double<N> operator/(U a, const multi_double<N>& b) {
+    return multi_double<N>(a) /= b;
+}
+
+//------------------------------------------------------------------------------
+// Comparisons, component by component since the components do not overlap
+template <int N>
+int compare(const multi_double<N>& a, const multi_double<N>& b) {
+    for ( int k = 0; k < N; k++ )
+        if ( a[k] != b[k] ) return a[k] < b[k] ? -1 : 1;
+
+    return 0;
+}
+
+template <int N>
+bool operator==(const multi_double<N>& a, const multi_double<N>& b) {
+    return compare(a, b) == 0;
+}
+template <int N>
+bool operator!=(const multi_double<N>& a, const multi_double<N>& b) {
+    return compare(a, b) != 0;
+}
+template <int N>
+bool operator<(const multi_double<N>& a, const multi_double<N>& b) {
+    return compare(a, b) < 0;
+}
+template <int N>
+bool operator>(const multi_double<N>& a, const multi_double<N>& b) {
+    return compare(a, b) > 0;
+}
+template <int N>
+bool operator<=(const multi_double<N>& a, const multi_double<N>& b) {
+    return compare(a, b) <= 0;
+}
+template <int N>
+bool operator>=(const multi_double<N>& a, const multi_double<N>& b) {
+    return compare(a, b) >= 0;
+}
+
+template <int N, typename U, typename = typename std::enable_if<
+    std::is_arithmetic<U>::value>::type>
+bool operator==(const multi_double<N>& a, U b) {
+    return a == multi_double<N>(b);
+}
+template <int N, typename U, typename = typename std::enable_if<
+    std::is_arithmetic<U>::value>::type>
+bool operator!=(const multi_double<N>& a, U b) {
+    return a != multi_double<N>(b);
+}
+template <int N, typename U, typename = typename std::enable_if<
+    std::is_arithmetic<U>::value>::type>
+bool operator<(const multi_double<N>& a, U b) {
+    return a < multi_double<N>(b);
+}
+template <int N, typename U, typename = typename std::enable_if<
+    std::is_arithmetic<U>::value>::type>
+bool operator>(const multi_double<N>& a, U b) {
+    return a > multi_double<N>(b);
+}
+template <int N, typename U, typename = typename std::enable_if<
+    std::is_arithmetic<U>::value>::type>
+bool operator<=(const multi_double<N>& a, U b) {
+    return a <= multi_double<N>(b);
+}
+template <int N, typename U, typename = typename std::enable_if<
+    std::is_arithmetic<U>::value>::type>
+bool operator>=(const multi_double<N>& a, U b) {
+    return a >= multi_double<N>(b);
+}
+
+//------------------------------------------------------------------------------
+// Functions
+template <int N>
+multi_double<N> abs(const multi_double<N>& a) {
+    return a[0] < 0 ? -a : a;
+}
+
+// Newton's iteration for 1/sqrt(a), which doubles the correct digits of the
+// double estimate each time, followed by a product by a
+template <int N>
+multi_double<N> sqrt(const multi_double<N>& a) {
+    if ( a[0] <= 0 )
+        return a[0] == 0 ? a :
+            multi_double<N>(std::numeric_limits<double>::quiet_NaN());
+
+    multi_double<N> y(1/std::sqrt(a[0])), t;
+    multi_double<N> h = a*0.5;
+
+    for ( int n = 53; n <= N*53; n *= 2 ) {
+        t = y*y;
+        t *= h;
+        y += y*(0.5 - t);
+    }
+
+    return a*y;
+}
+
+template <int N>
+multi_double<N> pow(multi_double<N> a, int n) {
+    multi_double<N> y(1);
+    const bool inverse = n < 0;
+    if ( inverse ) n = -n;
+
+    for ( ; n > 0; n /= 2 ) {
+        if ( n % 2 ) y *= a;
+        a *= a;
+    }
+
+    return inverse ? 1/y : y;
+}
+
+// Through MPFR; only needed outside of the inner loops
+template <int N>
+multi_double<N> log10(const multi_double<N>& a) {
+    mpfr_t r;
+    mpfr_init2(r, N*53 + 10);
+    a.get(r);
+    mpfr_log10(r, r, MPFR_RNDN);
+    multi_double<N> y(r);
+    mpfr_clear(r);
+
+    return y;
+}
+
+// Printed through MPFR with the precision of os
+template <int N>
+std::ostream& operator<<(std::ostream& os, const multi_double<N>& a) {
+    const unsigned digits = std::max<std::streamsize>(os.precision(), 17);
+    boost::multiprecision::mpfr_float y(0, digits);
+    a.get(y.backend().data());
+
+    return os << y;
+}
+
+//------------------------------------------------------------------------------
+// Whether T has the exponent range of double, so that out_of_range can be
+// true for it
+template <class T>
+struct limited_range : std::false_type {};
+
+template <int N>
+struct limited_range<multi_double<N>> : std::true_type {};
+
+template <class T>
+struct limited_range<solver::dual<T>> : limited_range<T> {};
+
+// Whether x is zero, not finite, or too close to the limits of the exponent
+// range of double for all the components of a multi_double to be normal
+// numbers. For a computed result, zero then usually comes from an underflow;
+// an exact zero that did not, such as H[D,d] landing on a root, is also
+// reported, which only costs a fallback to a wider type. Always false for 
+// other types.
+template <class T>
+bool out_of_range(const T&) {return false;}
+
+template <int N>
+bool out_of_range(const multi_double<N>& x) {
+    const double a = std::abs(x[0]);
+    return ! ( a > std::ldexp(1., -1022 + 53*N) && a < std::ldexp(1., 1000) );
+}
+
+// An exact zero derivative is a legitimate value, e.g. that of a constant,
+// and an underflow of the derivative alone cannot be told from it, so only
+// nonzero derivatives are checked
+template <class T>
+bool out_of_range(const solver::dual<T>& x) {
+    return out_of_range(x.value()) 
+        || ( x.derivative() != 0 && out_of_range(x.derivative()) );
+}
+
+// Same as out_of_range for x*x
+template <class T>
+bool square_out_of_range(const T&) {return false;}
+
+template <int N>
+bool square_out_of_range(const multi_double<N>& x) {
+    const double a = std::abs(x[0]);
+    return ! ( a > std::ldexp(1., (-1022 + 53*N)/2) && a < std::ldexp(1., 500) );
+}
+
+template <class T>
+bool square_out_of_range(const solver::dual<T>& x) {
+    return square_out_of_range(x.value()) 
+        || ( x.derivative() != 0 && square_out_of_range(x.derivative()) );
+}
+
+} // namespace
+
+namespace std {
+template <int N>
+class numeric_limits<ricpad::multi_double<N>> : public numeric_limits<double> {
+    public:
+        static constexpr int digits = 53*N - 3*(N-1);
+        static constexpr int digits10 = int((digits - 1)*0.30102999566398120);
+        static constexpr int max_digits10 = digits10 + 2;
+
+        static ricpad::multi_double<N> epsilon() {
+            return std::ldexp(1., 1 - digits);
+        };
+        static ricpad::multi_double<N> min() {
+            return std::ldexp(1., -1022 + 53*N);
+        };
+        static ricpad::multi_double<N> max() {
+            return numeric_limits<double>::max();
+        };
+        static ricpad::multi_double<N> lowest() {
+            return -numeric_limits<double>::max();
+        };
+};
+}
+#endif
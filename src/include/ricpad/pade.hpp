@@ -0,0 +1,186 @@
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include <boost/math/policies/error_handling.hpp>
+
+#ifndef RICPAD_PADE
+#define RICPAD_PADE
+
+namespace ricpad::pade {
+
+// Coefficients of the [M/N] Pade approximant P(t)/Q(t) of the series with
+// coefficients c[0]...c[M+N], normalized so that q[0] = 1. The denominator
+// solves
+//
+//     sum_{k=1}^{N} q[k]*c[M+i-k] = -c[M+i],    i = 1...N,
+//
+// (with c[j] = 0 for j < 0), whose matrix is the Hankel matrix of
+// c[M-N+1]...c[M+N-1] with its columns in reverse order, so that the
+// approximant exists when the determinant H[N,M-N] of the Hankel-Pade
+// method does not vanish. The system is solved by Gaussian elimination with
+// partial pivoting, and the numerator follows from p = (c*q) truncated to
+// degree M.
+template <class T>
+void pade(
+        const int M,
+        const int N,
+        // Coefficients c[0]...c[M+N]
+        const T* c,
+        std::vector<T>& p,
+        std::vector<T>& q
+        ) {
+    using std::vector;
+    static const char* function = "ricpad::pade::pade<%1%>";
+
+    auto coef = [c] (const int j) -> T {return j < 0 ? T(0) : c[j];};
+
+    // Augmented matrix of the system for q[1]...q[N]
+    vector<vector<T>> a(N, vector<T>(N+1));
+    for ( int i = 0; i < N; i++ ) {
+        for ( int k = 0; k < N; k++ ) a[i][k] = coef(M+i-k);
+        a[i][N] = -coef(M+i+1);
+    }
+
+    for ( int k = 0; k < N; k++ ) {
+        int r = k;
+        for ( int i = k+1; i < N; i++ ) {
+            if ( abs(a[i][k]) > abs(a[r][k]) ) r = i;
+        }
+
+        if ( a[r][k] == 0 ) {
+            boost::math::policies::raise_evaluation_error(
+                function,
+                "The [M/N] approximant does not exist for N = %1%. ",
+                N,
+                boost::math::policies::policy<>());
+            return;
+        }
+
+        if ( r != k ) std::swap(a[r], a[k]);
+
+        for ( int i = k+1; i < N; i++ ) {
+            T m = a[i][k]/a[k][k];
+            for ( int j = k+1; j <= N; j++ ) {
+                a[i][j] -= m*a[k][j];
+            }
+        }
+    }
+
+    q.assign(N+1, T(0));
+    q[0] = 1;
+    for ( int k = N-1; k >= 0; k-- ) {
+        T s = a[k][N];
+        for ( int j = k+1; j < N; j++ ) s -= a[k][j]*q[j+1];
+        q[k+1] = s/a[k][k];
+    }
+
+    p.assign(M+1, T(0));
+    for ( int j = 0; j <= M; j++ ) {
+        for ( int k = 0; k <= std::min(j, N); k++ ) p[j] += q[k]*c[j-k];
+    }
+}
+
+// Rational function P(t)/Q(t) with its coefficients rounded to R, which is
+// either double or long double, for evaluating it at many points. Points
+// with |t| > 1 use the reversed polynomials in 1/t,
+//
+//     P(t)/Q(t) = t^(M-N) * (p[M] + ... + p[0]/t^M)/(q[N] + ... + q[0]/t^N),
+//
+// so that no power of t grows large.
+template <class R>
+class Rational {
+    private:
+        // Coefficients of P and Q, lowest degree first
+        std::vector<R> p_, q_;
+
+        // Number of points evaluated together. The scratch arrays of a block
+        // stay in the L1 cache.
+        static const int block_ = 256;
+
+        // Evaluate a polynomial with coefficients c at the points s[0]...
+        // s[n-1], or the reversed polynomial if reversed is set. Each step of
+        // the Horner scheme runs over all the points, so that the inner loop
+        // has no dependencies between them and vectorizes.
+        static void horner(
+                const std::vector<R>& c, const bool reversed, const R* s, 
+                R* y, const int n
+                ) {
+            const int m = int(c.size()) - 1;
+            const R first = reversed ? c[0] : c[m];
+
+            for ( int i = 0; i < n; i++ ) y[i] = first;
+
+            for ( int k = 1; k <= m; k++ ) {
+                const R ck = reversed ? c[k] : c[m-k];
+                for ( int i = 0; i < n; i++ ) y[i] = y[i]*s[i] + ck;
+            }
+        };
+
+    public:
+        Rational() : p_(1, R(0)), q_(1, R(1)) {};
+
+        template <class T>
+        Rational(const std::vector<T>& p, const std::vector<T>& q) {
+            for ( const T& c : p ) p_.push_back(R(c));
+            for ( const T& c : q ) q_.push_back(R(c));
+        };
+
+        //----------------------------------------------------------------------
+        // Degrees of the numerator and the denominator
+        int M() const {return int(p_.size()) - 1;};
+        int N() const {return int(q_.size()) - 1;};
+
+        //----------------------------------------------------------------------
+        // Values at the points t[0]...t[n-1], stored in y, which may be t. 
+        // The points of each block are split into those with |t| <= 1 and 
+        // the rest, which are evaluated separately.
+        void evaluate(const R* t, R* y, const std::size_t n) const {
+            R s[block_], yp[block_], yq[block_];
+            int index[block_];
+            const int shift = M() - N();
+
+            for ( std::size_t start = 0; start < n; start += block_ ) {
+                const int b = int(std::min<std::size_t>(block_, n - start));
+                const R* tb = t + start;
+                R* yb = y + start;
+
+                // Points with |t| <= 1 first, and the rest after them
+                int nnear = 0, nfar = 0;
+                for ( int i = 0; i < b; i++ ) {
+                    if ( std::abs(tb[i]) > 1 ) {
+                        nfar++;
+                        index[b-nfar] = i;
+                        s[b-nfar] = 1/tb[i];
+                    } else {
+                        index[nnear] = i;
+                        s[nnear++] = tb[i];
+                    }
+                }
+
+                horner(p_, false, s, yp, nnear);
+                horner(q_, false, s, yq, nnear);
+                horner(p_, true, s + nnear, yp + nnear, nfar);
+                horner(q_, true, s + nnear, yq + nnear, nfar);
+
+                for ( int i = 0; i < b; i++ ) yp[i] /= yq[i];
+
+                if ( shift != 0 ) {
+                    for ( int i = nnear; i < b; i++ ) 
+                        yp[i] *= std::pow(tb[index[i]], shift);
+                }
+
+                for ( int i = 0; i < b; i++ ) yb[index[i]] = yp[i];
+            }
+        };
+
+        // Value at a single point
+        R operator()(const R t) const {
+            R y;
+            evaluate(&t, &y, 1);
+            return y;
+        };
+};
+
+} // namespace
+#endif
@@ -0,0 +1,78 @@
+#include <type_traits>
+#include <boost/multiprecision/mpfr.hpp>
+
+#include <solver/dual.hpp>
+
+#ifndef RICPAD_PRECISION
+#define RICPAD_PRECISION
+
+namespace ricpad {
+
+namespace detail {
+// Newer Boost versions keep a default precision per thread; older ones only
+// have the global default_precision.
+template <class T, class = void>
+struct has_thread_precision : std::false_type {};
+
+template <class T>
+struct has_thread_precision<T,
+    decltype(void(T::thread_default_precision()))> : std::true_type {};
+
+template <class T>
+unsigned get_default_precision(std::true_type) {
+    return T::thread_default_precision();
+}
+template <class T>
+unsigned get_default_precision(std::false_type) {
+    return T::default_precision();
+}
+
+template <class T>
+void set_default_precision(unsigned digits, std::true_type) {
+    T::thread_default_precision(digits);
+}
+template <class T>
+void set_default_precision(unsigned digits, std::false_type) {
+    T::default_precision(digits);
+}
+} // namespace detail
+
+// Working precision of the number type T, in decimal digits. Fixed precision
+// types ignore it.
+template <class T>
+struct precision {
+    // Whether set() only affects the calling thread
+    static const bool per_thread = true;
+
+    static unsigned get() {return 0;};
+    static void set(unsigned) {};
+    // Change the precision of an existing number
+    static void apply(T&, unsigned) {};
+};
+
+template <>
+struct precision<boost::multiprecision::mpfr_float> {
+    typedef boost::multiprecision::mpfr_float T;
+    typedef detail::has_thread_precision<T> tag;
+
+    static const bool per_thread = tag::value;
+
+    static unsigned get() {return detail::get_default_precision<T>(tag());};
+
+    // Set the precision of the numbers created by the calling thread. Without
+    // per_thread this changes it for every thread, so concurrent computations
+    // must then share the same precision.
+    static void set(unsigned digits) {
+        if ( digits != get() ) detail::set_default_precision<T>(digits, tag());
+    };
+
+    // Change the precision of an existing number
+    static void apply(T& x, unsigned digits) {x.precision(digits);};
+};
+
+// Dual numbers work with the precision of their components
+template <class T>
+struct precision<solver::dual<T>> : public precision<T> {};
+
+} // namespace
+#endif
@@ -0,0 +1,86 @@
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#ifndef RICPAD_THREAD_POOL
+#define RICPAD_THREAD_POOL
+
+namespace ricpad {
+
+// Fixed set of worker threads consuming a queue of tasks. Tasks are submitted
+// with submit(), which returns a std::future for their result; exceptions
+// thrown by a task are rethrown by the future's get().
+class ThreadPool {
+    private:
+        std::vector<std::thread> workers_;
+        std::queue<std::function<void()>> tasks_;
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        bool stop_ = false;
+
+        void work() {
+            while ( true ) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    cv_.wait(lock, [this] {return stop_ || !tasks_.empty();});
+                    if ( stop_ && tasks_.empty() ) return;
+                    task = std::move(tasks_.front());
+                    tasks_.pop();
+                }
+                task();
+            }
+        };
+
+    public:
+        //----------------------------------------------------------------------
+        // Start nthreads workers (at least one)
+        ThreadPool(int nthreads) {
+            if ( nthreads < 1 ) nthreads = 1;
+            for ( int i = 0; i < nthreads; i++ ) {
+                workers_.emplace_back([this] {work();});
+            }
+        };
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // Finish the queued tasks and join the workers
+        ~ThreadPool() {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            cv_.notify_all();
+            for ( auto& w : workers_ ) w.join();
+        };
+
+        //----------------------------------------------------------------------
+        // Getters
+        int size() const {return workers_.size();};
+
+        //----------------------------------------------------------------------
+        // Queue f() for execution
+        template <typename F>
+        std::future<typename std::result_of<F()>::type> submit(F f) {
+            typedef typename std::result_of<F()>::type R;
+
+            auto task = std::make_shared<std::packaged_task<R()>>(std::move(f));
+            std::future<R> result = task->get_future();
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                tasks_.emplace([task] {(*task)();});
+            }
+            cv_.notify_one();
+
+            return result;
+        };
+};
+
+} // namespace
+#endif
@@ -0,0 +1,197 @@
+#ifndef RICPAD_DUAL
+#define RICPAD_DUAL
+
+#include <limits>
+#include <ostream>
+#include <type_traits>
+
+namespace solver {
+
+// Dual number v + d*e, with e^2 = 0, over the real type T. Evaluating a
+// function on dual(x, 1) yields its value and its exact first derivative at x
+// (forward-mode automatic differentiation).
+template <typename T>
+class dual {
+    private:
+        // Value
+        T v_;
+        // Derivative
+        T d_;
+
+    public:
+        //----------------------------------------------------------------------
+        // Constructors
+        dual() : v_(0), d_(0) {};
+        dual(const T& v) : v_(v), d_(0) {};
+        dual(const T& v, const T& d) : v_(v), d_(d) {};
+
+        // Constants from built-in numbers, e.g. num_t(1) or return 1
+        template <typename U, typename = typename std::enable_if<
+            std::is_arithmetic<U>::value>::type>
+        dual(U v) : v_(v), d_(0) {};
+
+        //----------------------------------------------------------------------
+        // Getters
+        const T& value() const {return v_;};
+        const T& derivative() const {return d_;};
+
+        //----------------------------------------------------------------------
+        // Arithmetic
+        dual& operator+=(const dual& b) {
+            v_ += b.v_;
+            d_ += b.d_;
+            return *this;
+        };
+
+        dual& operator-=(const dual& b) {
+            v_ -= b.v_;
+            d_ -= b.d_;
+            return *this;
+        };
+
+        dual& operator*=(const dual& b) {
+            d_ = d_*b.v_ + v_*b.d_;
+            v_ *= b.v_;
+            return *this;
+        };
+
+        dual& operator/=(const dual& b) {
+            v_ /= b.v_;
+            d_ = (d_ - v_*b.d_)/b.v_;
+            return *this;
+        };
+
+        // Scaling by a real number costs two multiplications instead of three
+        dual& operator*=(const T& b) {
+            v_ *= b;
+            d_ *= b;
+            return *this;
+        };
+
+        template <typename U, typename = typename std::enable_if<
+            std::is_arithmetic<U>::value>::type>
+        dual& operator*=(U b) {
+            v_ *= b;
+            d_ *= b;
+            return *this;
+        };
+
+        template <typename U, typename = typename std::enable_if<
+            std::is_arithmetic<U>::value>::type>
+        dual& operator/=(U b) {
+            v_ /= b;
+            d_ /= b;
+            return *this;
+        };
+
+        dual operator-() const {return dual(T(-v_), T(-d_));};
+};
+
+//------------------------------------------------------------------------------
+// Binary operators. Built-in numbers are accepted on either side, since the
+// recurrences use integer weights such as (k+2)*(k+1)*f[k+2].
+template <typename T>
+dual<T> operator+(dual<T> a, const dual<T>& b) {return a += b;};
+template <typename T>
+dual<T> operator-(dual<T> a, const dual<T>& b) {return a -= b;};
+template <typename T>
+dual<T> operator*(dual<T> a, const dual<T>& b) {return a *= b;};
+template <typename T>
+dual<T> operator/(dual<T> a, const dual<T>& b) {return a /= b;};
+
+template <typename T>
+dual<T> operator*(dual<T> a, const T& b) {return a *= b;};
+template <typename T>
+dual<T> operator*(const T& a, dual<T> b) {return b *= a;};
+
+template <typename T, typename U, typename = typename std::enable_if<
+    std::is_arithmetic<U>::value>::type>
+dual<T> operator+(dual<T> a, U b) {return a += dual<T>(b);};
+template <typename T, typename U, typename = typename std::enable_if<
+    std::is_arithmetic<U>::value>::type>
+dual<T> operator+(U a, dual<T> b) {return b += dual<T>(a);};
+
+template <typename T, typename U, typename = typename std::enable_if<
+    std::is_arithmetic<U>::value>::type>
+dual<T> operator-(dual<T> a, U b) {return a -= dual<T>(b);};
+template <typename T, typename U, typename = typename std::enable_if<
+    std::is_arithmetic<U>::value>::type>
+dual<T> operator-(U a, const dual<T>& b) {return dual<T>(a) -= b;};
+
+template <typename T, typename U, typename = typename std::enable_if<
+    std::is_arithmetic<U>::value>::type>
+dual<T> operator*(dual<T> a, U b) {return a *= b;};
+template <typename T, typename U, typename = typename std::enable_if<
+    std::is_arithmetic<U>::value>::type>
+dual<T> operator*(U a, dual<T> b) {return b *= a;};
+
+template <typename T, typename U, typename = typename std::enable_if<
+    std::is_arithmetic<U>::value>::type>
+dual<T> operator/(dual<T> a, U b) {return a /= b;};
+template <typename T, typename U, typename = typename std::enable_if<
+    std::is_arithmetic<U>::value>::type>
+dual<T> operator/(U a, const dual<T>& b) {return dual<T>(a) /= b;};
+
+//------------------------------------------------------------------------------
+// Comparisons only look at the value
+template <typename T>
+bool operator==(const dual<T>& a, const dual<T>& b) {
+    return a.value() == b.value();
+};
+template <typename T>
+bool operator!=(const dual<T>& a, const dual<T>& b) {
+    return a.value() != b.value();
+};
+template <typename T>
+bool operator<(const dual<T>& a, const dual<T>& b) {
+    return a.value() < b.value();
+};
+template <typename T>
+bool operator>(const dual<T>& a, const dual<T>& b) {
+    return a.value() > b.value();
+};
+template <typename T>
+bool operator<=(const dual<T>& a, const dual<T>& b) {
+    return a.value() <= b.value();
+};
+template <typename T>
+bool operator>=(const dual<T>& a, const dual<T>& b) {
+    return a.value() >= b.value();
+};
+
+template <typename T, typename U, typename = typename std::enable_if<
+    std::is_arithmetic<U>::value>::type>
+bool operator==(const dual<T>& a, U b) {return a.value() == b;};
+template <typename T, typename U, typename = typename std::enable_if<
+    std::is_arithmetic<U>::value>::type>
+bool operator!=(const dual<T>& a, U b) {return a.value() != b;};
+template <typename T, typename U, typename = typename std::enable_if<
+    std::is_arithmetic<U>::value>::type>
+bool operator<(const dual<T>& a, U b) {return a.value() < b;};
+template <typename T, typename U, typename = typename std::enable_if<
+    std::is_arithmetic<U>::value>::type>
+bool operator>(const dual<T>& a, U b) {return a.value() > b;};
+
+template <typename T>
+dual<T> abs(const dual<T>& a) {
+    return a.value() < 0 ? -a : a;
+};
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const dual<T>& a) {
+    return os << a.value();
+};
+
+}; // namespace solver
+
+// Limits are those of the underlying type, as constants with zero derivative
+namespace std {
+template <typename T>
+class numeric_limits<solver::dual<T>> : public numeric_limits<T> {
+    public:
+        static solver::dual<T> epsilon() {return numeric_limits<T>::epsilon();};
+        static solver::dual<T> min() {return (numeric_limits<T>::min)();};
+        static solver::dual<T> max() {return (numeric_limits<T>::max)();};
+};
+}
+#endif
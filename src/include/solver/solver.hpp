@@ -3,9 +3,15 @@
 
 #include <iostream>
 #include <stdexcept>
+#include <vector>
+#include <future>
+#include <algorithm>
 #include <math.h>
 
+#include <ricpad/precision.hpp>
+#include <ricpad/thread_pool.hpp>
 #include <solver/differentiate.hpp>
+#include <solver/dual.hpp>
 
 namespace solver { 
     //
@@ -15,9 +21,29 @@ template <
     typename R  // real number type (for tolerance parameters, etc.)
 >
 class Solver {
+    public:
+        // Iterations available for solve(). The number of evaluations of f 
+        // per iteration and the order of convergence are
+        //
+        //     newton      3 (1 with dual numbers)   2
+        //     secant      1                         1.618
+        //     steffensen  2                         2
+        //     illinois    1                         1.442, keeps a bracket
+        //     brent       1                         superlinear, keeps a 
+        //                                           bracket
+        //     halley      3 (2 with dual numbers)   3
+        enum class Method {newton, secant, steffensen, illinois, brent, halley};
+
     private:
         // Function to solve
         const std::function<C(C&)> f_;
+        // Function to solve, evaluated on dual numbers (only relevant when
+        // using automatic differentiation)
+        const std::function<dual<C>(dual<C>&)> fd_;
+        // Function to solve, evaluated at several points at once
+        const std::function<std::vector<C>(std::vector<C>&)> fb_;
+        // Threads for evaluating f_ at several points concurrently
+        ricpad::ThreadPool* pool_ = nullptr;
         //Eigen::Matrix<C,N,1> x0;
         // Accepted difference between two iterations
         R tol_; 
@@ -26,6 +52,15 @@ class Solver {
         R h_;
         // Maximum number of iterations
         int maxiter_ = 100;
+        // Iteration used by solve()
+        Method method_ = Method::newton;
+        // Distance from x0 to the second starting point of the secant 
+        // method, and to the other end of the first bracket tried by the
+        // bracketing methods
+        R step_;
+        // Iterations and evaluations of f performed by the last solve
+        int niter_ = 0;
+        int nevals_ = 0;
         // Print each iteration?
         bool log_iters_ = false;
         int  log_precision_ = 15;
@@ -40,13 +75,46 @@ class Solver {
                 //h_   = std::sqrt(std::numeric_limits<R>::epsilon());
                 h_   = 1e-12;
                 tol_ = 1e-8;
+                step_ = 1e-3;
+            };
+
+        //----------------------------------------------------------------------
+        // Construct a Solver object from a function that accepts dual numbers.
+        // The derivative is obtained exactly from the same evaluation as the 
+        // function value, so each iteration needs a single evaluation and h
+        // is not used.
+        Solver(const std::function<dual<C>(dual<C>&)> &fd) :
+
+            fd_(fd) {
+                h_   = 1e-12;
+                tol_ = 1e-8;
+                step_ = 1e-3;
+            };
+
+        //----------------------------------------------------------------------
+        // Construct a Solver object from a function that evaluates f at 
+        // every point of its argument, and returns the values in the same 
+        // order. This lets the caller evaluate the points of each iteration 
+        // concurrently or in a vectorized way. Differentiation is performed
+        // numerically.
+        Solver(const std::function<std::vector<C>(std::vector<C>&)> &fb) :
+
+            fb_(fb) {
+                h_   = 1e-12;
+                tol_ = 1e-8;
+                step_ = 1e-3;
             };
 
         //----------------------------------------------------------------------
         // Setters
         void set_h(R h) {h_ = h;};
+        // Evaluate f(x+h), f(x-h) and f(x) concurrently, using the threads 
+        // of pool besides the calling one.
+        void set_pool(ricpad::ThreadPool* pool) {pool_ = pool;};
         void set_tol(R tol) {tol_ = tol;};
         void set_maxiter(int maxiter) {maxiter_ = maxiter;};
+        void set_method(Method method) {method_ = method;};
+        void set_step(R step) {step_ = step;};
         void set_log(int precision) {
             log_iters_ = true;
             log_precision_ = precision;
@@ -58,52 +126,531 @@ class Solver {
         //----------------------------------------------------------------------
         // Getters
         int maxiter() {return maxiter_;};
+        int iterations() const {return niter_;};
+        int evaluations() const {return nevals_;};
+
+        //----------------------------------------------------------------------
+        // Evaluate the function at every point of xs
+        std::vector<C> evaluate(std::vector<C>& xs) {
+            nevals_ += xs.size();
+            if ( fb_ ) return fb_(xs);
+
+            std::vector<C> ys(xs.size());
+
+            if ( pool_ ) {
+                const unsigned digits = ricpad::precision<C>::get();
+                std::vector<std::future<void>> tasks;
+
+                for ( int i = 1; i < int(xs.size()); i++ ) {
+                    tasks.push_back(pool_->submit([this, &xs, &ys, i, digits] {
+                        ricpad::precision<C>::set(digits);
+                        ys[i] = f_(xs[i]);
+                    }));
+                }
+                if ( ! xs.empty() ) ys[0] = f_(xs[0]);
+                for ( auto& t : tasks ) t.get();
+            } else {
+                for ( int i = 0; i < int(xs.size()); i++ ) ys[i] = f_(xs[i]);
+            }
+
+            return ys;
+        };
+
+        //----------------------------------------------------------------------
+        // One Newton-Raphson iteration from x, using step size h for the 
+        // numerical derivative
+        C newton_step(const C& x, const R& h) {
+            C jacobian, inv_jacobian, F, val;
+
+            if ( fd_ ) {
+                dual<C> xd(x, C(1));
+                dual<C> y = fd_(xd);
+                nevals_++;
+
+                F = y.value();
+                jacobian = y.derivative();
+            } else {
+                // f(x+h), f(x-h), f(x)
+                std::vector<C> xs(3, x);
+                xs[0] += h;
+                xs[1] -= h;
+
+                std::vector<C> ys = evaluate(xs);
+
+                val = ys[0] - ys[1];
+                val /= (h*C(2));
+                jacobian = std::move(val);
+
+                F = std::move(ys[2]);
+            }
+
+            inv_jacobian = 1/jacobian;
+
+            return x - inv_jacobian * F;
+        };
+
+        //----------------------------------------------------------------------
+        // One Halley iteration from x. The second derivative comes from the
+        // same three points as the first one, or from the exact derivatives
+        // at x and x + sqrt(epsilon)*max(1, |x|) when using dual numbers. 
+        // Since the second difference loses twice as many digits as the 
+        // first one, the three points are at least epsilon^(1/4)*max(1, |x|)
+        // apart. When the Halley correction is not small the Newton step is
+        // taken instead.
+        C halley_step(const C& x, const R& h) {
+            C F, J, K, den;
+
+            if ( fd_ ) {
+                C hK = sqrt(std::numeric_limits<C>::epsilon());
+                if ( abs(x) > 1 ) hK *= abs(x);
+
+                dual<C> xd(x, C(1)), xh(x + hK, C(1));
+                dual<C> y = fd_(xd), yh = fd_(xh);
+                nevals_ += 2;
+
+                F = y.value();
+                J = y.derivative();
+                K = (yh.derivative() - J)/hK;
+            } else {
+                C hK = sqrt(sqrt(std::numeric_limits<C>::epsilon()));
+                if ( abs(x) > 1 ) hK *= abs(x);
+                if ( hK < h ) hK = h;
+
+                std::vector<C> xs(3, x);
+                xs[0] += hK;
+                xs[1] -= hK;
+
+                std::vector<C> ys = evaluate(xs);
+
+                J = (ys[0] - ys[1])/(hK*C(2));
+                K = (ys[0] - 2*ys[2] + ys[1])/(hK*hK);
+                F = std::move(ys[2]);
+            }
+
+            den = 2*J*J - F*K;
+            if ( abs(F*K) > J*J ) return x - F/J;
+
+            return x - 2*F*J/den;
+        };
+
+        //----------------------------------------------------------------------
+        // Evaluate the function at x
+        C value(const C& x) {
+            if ( fb_ ) {
+                std::vector<C> xs(1, x);
+                return evaluate(xs)[0];
+            }
+
+            nevals_++;
+            C y(x);
+
+            if ( fd_ ) {
+                dual<C> yd(y);
+                return fd_(yd).value();
+            }
+
+            return f_(y);
+        };
+
+        void log_iteration(int niter, const C& x, int precision) {
+            std::cout << std::setw(8) << "( NR: " << niter << " )";
+            std::cout 
+                << std::setprecision(precision) 
+                << std::setw(precision + 10) << std::left
+                << x;
+            std::cout << std::endl;
+        };
+
+        //----------------------------------------------------------------------
+        // Count an iteration that yielded x, logging it, and throw if there
+        // were too many
+        void next_iteration(const C& x) {
+            if ( log_iters_ ) log_iteration(niter_, x, log_precision_);
+
+            if ( niter_++ > maxiter_ ) {
+                throw std::runtime_error(
+                        "Maximum number of iterations reached."
+                        );
+            }
+        };
 
         //----------------------------------------------------------------------
         // Solve for f using x0 as initial value
         C solve(C x0) 
         {
+            C x1 = x0 + step_;
+            return solve(x0, x1);
+        };
+
+        //----------------------------------------------------------------------
+        // Solve for f using x0 as initial value. The secant method starts 
+        // from x0 and x1, and the bracketing methods from the interval 
+        // between them, which is widened until f changes sign. The other
+        // methods ignore x1. If x1 == x0, x0 + step_ is used instead by the 
+        // secant method, and [x0 - step_, x0 + step_] by the bracketing ones.
+        C solve(C x0, C x1) 
+        {
+            niter_ = 0;
+            nevals_ = 0;
+
+            if ( x1 == x0 ) {
+                x1 += step_;
+                if ( method_ == Method::illinois || method_ == Method::brent )
+                    x0 -= step_;
+            }
+
+            switch ( method_ ) {
+                case Method::secant: 
+                    return secant(x0, x1);
+                case Method::steffensen:
+                    return steffensen(x0);
+                case Method::illinois: 
+                case Method::brent: {
+                    C f0 = value(x0), f1 = value(x1);
+                    bracket(x0, x1, f0, f1);
+
+                    if ( method_ == Method::brent ) 
+                        return brent(x0, x1, f0, f1);
+                    return illinois(x0, x1, f0, f1);
+                }
+                case Method::halley:
+                case Method::newton:
+                default:
+                    break;
+            }
 
-            using solver::differentiate;
-            C jacobian, inv_jacobian;
             C x(x0), xold;
             R desv = tol_ + 1;
 
-            int niter = 0;
+            while ( desv > tol_ ) {
+                xold = x;
+                if ( method_ == Method::halley ) {
+                    x = halley_step(x, h_);
+                } else {
+                    x = newton_step(x, h_);
+                }
 
-            C val;
+                desv = abs(x - xold);
 
-            while ( desv > tol_ ) {
-                val = differentiate<C>(f_, x, h_);
-                jacobian = std::move(val);
+                next_iteration(x);
+            }
 
-                inv_jacobian = 1/jacobian;
-                
-                C F;
+            return x;
+        };
 
-                F = f_(x); 
+        //----------------------------------------------------------------------
+        // Secant method from x0 and x1
+        C secant(C x0, C x1) 
+        {
+            C f0 = value(x0), f1 = value(x1), x2;
 
-                xold = x;
-                x = x - inv_jacobian * F;
+            while ( true ) {
+                if ( f1 == f0 ) {
+                    throw std::runtime_error(
+                            "The secant method found two equal values of f."
+                            );
+                }
 
-                desv = abs(x - xold);
+                x2 = x1 - f1*(x1 - x0)/(f1 - f0);
+                next_iteration(x2);
 
-                if ( log_iters_ ) {
-                    std::cout << std::setw(8) << "( NR: " << niter << " )";
-                    std::cout 
-                        << std::setprecision(log_precision_) 
-                        << std::setw(log_precision_ + 10) << std::left
-                        << x;
-                    std::cout << std::endl;
+                if ( abs(x2 - x1) <= tol_ ) return x2;
+
+                x0 = std::move(x1);
+                f0 = std::move(f1);
+                x1 = std::move(x2);
+                f1 = value(x1);
+            }
+        };
+
+        //----------------------------------------------------------------------
+        // Steffensen's method. The second point of each iteration is 
+        // x - f(x)/J, where J is the slope found by the previous one (a 
+        // central difference at x0 for the first), so that the method does 
+        // not depend on the scale of f.
+        C steffensen(C x) 
+        {
+            C F = value(x), J, s, Fs, xnew;
+
+            std::vector<C> xs(2, x);
+            xs[0] += h_;
+            xs[1] -= h_;
+            std::vector<C> ys = evaluate(xs);
+            J = (ys[0] - ys[1])/(h_*C(2));
+
+            while ( true ) {
+                s = F/J;
+                Fs = value(x - s);
+
+                // The slope degenerates. x is only a root if f vanishes
+                // there or the step it would take is within tol.
+                if ( Fs == F ) {
+                    if ( F == 0 || abs(s) <= tol_ ) return x;
+                    throw std::runtime_error(
+                            "Steffensen's method found two equal values of f."
+                            );
                 }
 
+                J = (F - Fs)/s;
+                xnew = x - F/J;
+                next_iteration(xnew);
 
-                if ( niter++ > maxiter_ ) {
+                if ( abs(xnew - x) <= tol_ ) return xnew;
+
+                x = std::move(xnew);
+                F = value(x);
+            }
+        };
+
+        //----------------------------------------------------------------------
+        // Widen [a, b] until f(a) and f(b) have opposite signs
+        void bracket(C& a, C& b, C& fa, C& fb) 
+        {
+            while ( (fa > 0) == (fb > 0) && fa != 0 && fb != 0 ) {
+                if ( abs(fa) < abs(fb) ) {
+                    a += (a - b)*C(1.6);
+                    fa = value(a);
+                } else {
+                    b += (b - a)*C(1.6);
+                    fb = value(b);
+                }
+
+                if ( niter_++ > maxiter_ ) {
+                    throw std::runtime_error(
+                            "Could not find an interval where f changes sign."
+                            );
+                }
+            }
+        };
+
+        //----------------------------------------------------------------------
+        // Illinois variant of the regula falsi in the bracket [a, b]
+        C illinois(C a, C b, C fa, C fb) 
+        {
+            if ( fa == 0 ) return a;
+            if ( fb == 0 ) return b;
+
+            C c(a), cold, fc;
+            int side = 0;
+
+            while ( true ) {
+                cold = c;
+                c = (a*fb - b*fa)/(fb - fa);
+                next_iteration(c);
+
+                if ( abs(c - cold) <= tol_ || abs(b - a) <= tol_ ) return c;
+
+                fc = value(c);
+                if ( fc == 0 ) return c;
+
+                if ( (fc > 0) == (fb > 0) ) {
+                    b = c;
+                    fb = fc;
+                    if ( side == -1 ) fa /= 2;
+                    side = -1;
+                } else {
+                    a = c;
+                    fa = fc;
+                    if ( side == 1 ) fb /= 2;
+                    side = 1;
+                }
+            }
+        };
+
+        //----------------------------------------------------------------------
+        // Brent's method in the bracket [a, b], combining inverse quadratic
+        // interpolation, the secant method and bisection
+        C brent(C a, C b, C fa, C fb) 
+        {
+            const R tol = tol_/2;
+            C c(b), fc(fb), d, e, m, p, q, r, s;
+
+            while ( true ) {
+                if ( (fb > 0) == (fc > 0) ) {
+                    c = a;
+                    fc = fa;
+                    d = b - a;
+                    e = d;
+                }
+
+                if ( abs(fc) < abs(fb) ) {
+                    a = b;
+                    b = c;
+                    c = a;
+                    fa = fb;
+                    fb = fc;
+                    fc = fa;
+                }
+
+                m = (c - b)/2;
+                if ( abs(m) <= tol || fb == 0 ) return b;
+
+                if ( abs(e) >= tol && abs(fa) > abs(fb) ) {
+                    s = fb/fa;
+
+                    if ( a == c ) {
+                        p = 2*m*s;
+                        q = 1 - s;
+                    } else {
+                        q = fa/fc;
+                        r = fb/fc;
+                        p = s*(2*m*q*(q - r) - (b - a)*(r - 1));
+                        q = (q - 1)*(r - 1)*(s - 1);
+                    }
+
+                    if ( p > 0 ) q = -q;
+                    p = abs(p);
+
+                    C bound = 3*m*q - abs(tol*q);
+                    if ( abs(e*q) < bound ) bound = abs(e*q);
+
+                    if ( 2*p < bound ) {
+                        e = d;
+                        d = p/q;
+                    } else {
+                        d = m;
+                        e = m;
+                    }
+                } else {
+                    d = m;
+                    e = m;
+                }
+
+                a = b;
+                fa = fb;
+
+                if ( abs(d) > tol ) {
+                    b += d;
+                } else {
+                    b += m > 0 ? C(tol) : C(-tol);
+                }
+
+                fb = value(b);
+                next_iteration(b);
+            }
+        };
+
+        //----------------------------------------------------------------------
+        // Solve for f using x0 as initial value, performing the first 
+        // iterations with less digits than the precision of the calling 
+        // thread. Only the last iterations run at full precision, where tol_
+        // and h_ apply as in solve().
+        //
+        // Evaluating f with p digits loses some number L of them to 
+        // cancellation, so a correction computed with p digits is accurate to
+        // about p - L digits. L is estimated first by comparing the first 
+        // correction computed with digits_min, 2*digits_min, 4*digits_min... 
+        // digits, until two consecutive ones agree to at least one digit. 
+        // Afterwards, when x is correct to c digits, the next iteration 
+        // yields 2c digits and is computed with L + 2c digits plus a guard, 
+        // so the working precision follows the quadratic convergence of the 
+        // method.
+        //
+        // The estimate stops at half the full precision, so that it never 
+        // costs much more than a full precision iteration; when it does not
+        // succeed, or when L leaves no room for cheaper iterations, 
+        // solve_escalating proceeds as solve() with Newton's method.
+        C solve_escalating(C x0, const unsigned digits_min) 
+        {
+            using std::pow;
+            using std::log10;
+            typedef ricpad::precision<C> prec;
+
+            // Extra digits kept at each precision level
+            const int guard = 10;
+
+            const unsigned digits_max = prec::get();
+
+            C x(x0), xnew, desv, desv_prev;
+            niter_ = 0;
+            nevals_ = 0;
+
+            auto digits_of = [] (const C& r) -> double {
+                return -static_cast<double>(C(log10(r)));
+            };
+
+            // Correct digits of x after a step of size d, kept between 0
+            // and digits_max so that they convert to int
+            auto correct_digits = [&] (const C& d) -> double {
+                const double c = digits_of(d/abs(x));
+                return c > 0 ? std::min(c, double(digits_max)) : 0;
+            };
+
+            // Newton-Raphson step from x with p digits
+            auto step = [&] (const unsigned p, const C& h) -> C {
+                prec::set(p);
+                C xp(x);
+                prec::apply(xp, p);
+                xp = newton_step(xp, h);
+
+                if ( log_iters_ ) log_iteration(niter_, xp, p);
+                if ( niter_++ > maxiter_ ) {
+                    prec::set(digits_max);
                     throw std::runtime_error(
                             "Maximum number of iterations reached."
                             );
-                    return x;
                 }
+
+                return xp;
+            };
+
+            // Estimate the number of digits lost to cancellation
+            unsigned pa = std::min(digits_min, digits_max), pb = 2*pa;
+            double lost = -1;
+
+            if ( pb <= digits_max/2 ) {
+                C h = pow(C(10), -int(pa/2));
+                C da = step(pa, h) - x, db;
+
+                for ( ; pb <= digits_max/2; pa = pb, pb *= 2 ) {
+                    db = step(pb, h) - x;
+
+                    C eps = abs(da - db)/abs(db);
+                    if ( eps < C(0.1) ) {
+                        lost = eps == 0 ? 0 : pa - digits_of(eps);
+                        prec::apply(db, pb);
+                        x += db;
+                        desv_prev = abs(db);
+                        break;
+                    }
+
+                    da = std::move(db);
+                }
+            }
+
+            // Escalate the precision as x converges. A step that does not
+            // move x means that x has converged at that precision, and the
+            // full precision iterations take over.
+            if ( lost >= 0 && desv_prev != 0 ) {
+                double correct = correct_digits(desv_prev);
+
+                while ( true ) {
+                    int p = int(lost + 2*correct) + guard;
+                    if ( p >= int(digits_max) ) break;
+
+                    xnew = step(p, pow(C(10), -int(correct)));
+                    desv = abs(xnew - x);
+                    x = std::move(xnew);
+                    if ( desv == 0 ) break;
+
+                    double correct_new = correct_digits(desv);
+                    if ( ! (correct_new > correct) ) break;
+                    correct = correct_new;
+                }
+            }
+
+            prec::set(digits_max);
+            prec::apply(x, digits_max);
+
+            R desv_full = tol_ + 1;
+
+            while ( desv_full > tol_ ) {
+                xnew = newton_step(x, h_);
+
+                desv_full = abs(xnew - x);
+                x = std::move(xnew);
+
+                next_iteration(x);
             }
 
             return x;
@@ -0,0 +1,229 @@
+#ifndef TF_CHECKPOINT_HPP
+#define TF_CHECKPOINT_HPP
+
+// stdio.h must come before mpfr.h for the mpfr_fpif functions
+#include <cstdio>
+#include <cstdint>
+#include <cerrno>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <mutex>
+#include <boost/multiprecision/mpfr.hpp>
+
+namespace mp = boost::multiprecision;
+using mp::mpfr_float;
+
+namespace checkpoint {
+
+//------------------------------------------------------------------------------
+// Binary input and output. Numbers are stored with mpfr_fpif_export, which
+// keeps their precision and every bit of their mantissa.
+template <typename T>
+bool write(FILE* file, const T& x) {
+    return fwrite(&x, sizeof(T), 1, file) == 1;
+}
+
+template <typename T>
+bool read(FILE* file, T& x) {
+    return fread(&x, sizeof(T), 1, file) == 1;
+}
+
+inline bool write(FILE* file, const mpfr_float& x) {
+    mpfr_float y(x);
+    return mpfr_fpif_export(file, y.backend().data()) == 0;
+}
+
+// x takes the precision of the stored number
+inline bool read(FILE* file, mpfr_float& x) {
+    return mpfr_fpif_import(x.backend().data(), file) == 0;
+}
+
+inline bool write(FILE* file, const std::string& s) {
+    std::uint32_t n = s.size();
+    return write(file, n) && fwrite(s.data(), 1, n, file) == n;
+}
+
+inline bool read(FILE* file, std::string& s) {
+    std::uint32_t n;
+    if ( ! read(file, n) || n > 1024 ) return false;
+
+    s.resize(n);
+    return fread(&s[0], 1, n, file) == n;
+}
+
+//------------------------------------------------------------------------------
+// State of a sweep over D after solving D, enough to continue it with the
+// same starting points and adaptive precision as if it had not stopped
+struct SweepState {
+    std::string mode;
+    int d = 0;
+    // Last D processed
+    int D = 0;
+    int nfailed = 0;
+    int ndigits = 0;
+    mpfr_float x, xold, dE, tol, h;
+    // Roots found so far, and their D
+    std::vector<mpfr_float> roots;
+    std::vector<int> roots_D;
+
+    //--------------------------------------------------------------------------
+    // Write the state to path. A temporary file is renamed at the end, so
+    // that path always holds a complete checkpoint.
+    bool save(const std::string& path) const {
+        const std::string tmp = path + ".tmp";
+        FILE* file = fopen(tmp.c_str(), "wb");
+        if ( ! file ) return false;
+
+        std::uint32_t n = roots.size();
+        bool ok = fwrite("tfckpt01", 1, 8, file) == 8
+            && write(file, mode)
+            && write(file, std::int32_t(d))
+            && write(file, std::int32_t(D))
+            && write(file, std::int32_t(nfailed))
+            && write(file, std::int32_t(ndigits))
+            && write(file, x) && write(file, xold) && write(file, dE)
+            && write(file, tol) && write(file, h)
+            && write(file, n);
+
+        for ( std::uint32_t k = 0; ok && k < n; k++ ) {
+            ok = write(file, std::int32_t(roots_D[k]))
+                && write(file, roots[k]);
+        }
+
+        if ( fclose(file) != 0 ) ok = false;
+        if ( ok ) ok = rename(tmp.c_str(), path.c_str()) == 0;
+
+        return ok;
+    };
+
+    //--------------------------------------------------------------------------
+    // Read the state from path. Returns false if it does not exist, and
+    // throws std::runtime_error if it exists but cannot be read or is not a
+    // valid checkpoint, so that it is not overwritten by a new sweep.
+    bool load(const std::string& path) {
+        FILE* file = fopen(path.c_str(), "rb");
+        if ( ! file && errno == ENOENT ) return false;
+        if ( ! file ) 
+            throw std::runtime_error("Could not read " + path + ".");
+
+        char magic[8];
+        std::int32_t d_, D_, nfailed_, ndigits_;
+        std::uint32_t n;
+
+        bool ok = fread(magic, 1, 8, file) == 8
+            && std::string(magic, 8) == "tfckpt01"
+            && read(file, mode)
+            && read(file, d_) && read(file, D_)
+            && read(file, nfailed_) && read(file, ndigits_)
+            && read(file, x) && read(file, xold) && read(file, dE)
+            && read(file, tol) && read(file, h)
+            && read(file, n);
+
+        roots.clear();
+        roots_D.clear();
+
+        for ( std::uint32_t k = 0; ok && k < n; k++ ) {
+            std::int32_t Dk;
+            mpfr_float r;
+
+            ok = read(file, Dk) && read(file, r);
+            roots_D.push_back(Dk);
+            roots.push_back(r);
+        }
+
+        fclose(file);
+
+        if ( ! ok ) 
+            throw std::runtime_error(path + " is not a valid checkpoint.");
+
+        d = d_;
+        D = D_;
+        nfailed = nfailed_;
+        ndigits = ndigits_;
+
+        return true;
+    };
+};
+
+//------------------------------------------------------------------------------
+// Roots already found, keyed by mode, d, D and the number of digits used,
+// and stored in a file that grows with each new root. Safe to use from
+// several threads.
+class ResultCache {
+    private:
+        typedef std::tuple<std::string, int, int, int> Key;
+
+        std::string path_;
+        std::map<Key, mpfr_float> roots_;
+        std::mutex mutex_;
+
+    public:
+        //----------------------------------------------------------------------
+        // Read the roots stored in path, if it exists
+        ResultCache(const std::string& path) : path_(path) {
+            FILE* file = fopen(path.c_str(), "rb");
+            if ( ! file ) return;
+
+            std::string mode;
+            std::int32_t d, D, ndigits;
+            mpfr_float x;
+
+            while ( read(file, mode) && read(file, d) && read(file, D)
+                    && read(file, ndigits) && read(file, x) ) {
+                roots_[Key(mode, d, D, ndigits)] = x;
+            }
+
+            fclose(file);
+        };
+
+        //----------------------------------------------------------------------
+        // Look up a root, leaving it in x. Returns false if it is not known.
+        bool find(
+                const std::string& mode, int d, int D, int ndigits,
+                mpfr_float& x
+                ) {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            auto it = roots_.find(Key(mode, d, D, ndigits));
+            if ( it == roots_.end() ) return false;
+
+            x = it->second;
+            return true;
+        };
+
+        //----------------------------------------------------------------------
+        // Add a root, appending it to the file. Returns false if it could
+        // not be written.
+        bool insert(
+                const std::string& mode, int d, int D, int ndigits,
+                const mpfr_float& x
+                ) {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            roots_[Key(mode, d, D, ndigits)] = x;
+
+            FILE* file = fopen(path_.c_str(), "ab");
+            if ( ! file ) return false;
+
+            bool ok = write(file, mode)
+                && write(file, std::int32_t(d))
+                && write(file, std::int32_t(D))
+                && write(file, std::int32_t(ndigits))
+                && write(file, x);
+
+            if ( fclose(file) != 0 ) ok = false;
+
+            return ok;
+        };
+
+        int size() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return roots_.size();
+        };
+};
+
+} // namespace
+#endif
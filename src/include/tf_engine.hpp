@@ -0,0 +1,1647 @@
+#ifndef TF_ENGINE_HPP
+#define TF_ENGINE_HPP
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <functional>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <future>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <boost/multiprecision/mpfr.hpp>
+
+#include <ricpad/chebyshev.hpp>
+#include <ricpad/extrapolation.hpp>
+#include <ricpad/hankdet.hpp>
+#include <ricpad/interval.hpp>
+#include <ricpad/multi_double.hpp>
+#include <ricpad/precision.hpp>
+#include <ricpad/thread_pool.hpp>
+#include <solver/dual.hpp>
+#include <solver/solver.hpp>
+#include <tf.hpp>
+#include <tf_checkpoint.hpp>
+#include <tf_polynomials.hpp>
+#include <tf_stats.hpp>
+
+namespace mp = boost::multiprecision;
+using mp::mpfr_float;
+
+// The pipeline that finds the roots of the Hankel determinants H[D,d]: the
+// series, the determinants, the solver and the rule that adapts the
+// precision from one D to the next. An Engine holds what can be shared by
+// many sweeps, such as thread pools and caches, and a Job describes one
+// sweep over D.
+namespace engine {
+
+typedef solver::dual<mpfr_float> dual_float;
+typedef solver::Solver<mpfr_float, mpfr_float> Solver;
+
+// Numbers with a fixed precision of N decimal digits, whose limbs live in
+// the number itself, so that neither they nor their temporaries allocate
+template <unsigned N>
+using fixed_float = mp::number<
+    mp::backends::mpfr_float_backend<N, mp::allocate_stack>, mp::et_on>;
+
+// The MPFR number x as num_t, or the other way round
+template <typename num_t>
+void from_mpfr(num_t& y, mpfr_srcptr x) {
+    mpfr_set(y.backend().data(), x, MPFR_RNDN);
+}
+
+template <int N>
+void from_mpfr(ricpad::multi_double<N>& y, mpfr_srcptr x) {
+    y = ricpad::multi_double<N>(x);
+}
+
+template <typename num_t>
+void to_mpfr(mpfr_ptr y, const num_t& x) {
+    mpfr_set(y, x.backend().data(), MPFR_RNDN);
+}
+
+template <int N>
+void to_mpfr(mpfr_ptr y, const ricpad::multi_double<N>& x) {
+    x.get(y);
+}
+
+// x converted to num_t, with the given digits if num_t has a variable 
+// precision. Any two of mpfr_float, fixed_float and multi_double can be
+// converted.
+template <typename num_t, typename other_t>
+num_t convert(const other_t &x, const unsigned digits) {
+    num_t y;
+    ricpad::precision<num_t>::apply(y, digits);
+
+    mpfr_float z(0, ricpad::precision<mpfr_float>::get());
+    to_mpfr(z.backend().data(), x);
+    from_mpfr(y, z.backend().data());
+
+    return y;
+}
+
+//------------------------------------------------------------------------------
+// How the Hankel determinants are computed
+struct HankelMethod {
+    // Either dodgson or chebyshev
+    std::string name = "dodgson";
+    // Threads for the levels of the Dodgson condensation, which are used for
+    // D >= Dserial
+    ricpad::ThreadPool* pool = nullptr;
+    int Dserial = 32;
+};
+
+// Hankel determinant of the coefficients in v, using the method selected with
+// the --hankdet option
+template <typename num_t>
+num_t hankel_determinant(
+        const HankelMethod &method, const int D, std::vector<num_t> &v
+        ) {
+    if ( method.name == "chebyshev" )
+        return ricpad::hankdet::hankdet_chebyshev<num_t>(D, v);
+
+    if ( method.pool )
+        return ricpad::hankdet::hankdet<num_t>(
+                D, v, *method.pool, method.Dserial);
+
+    return ricpad::hankdet::hankdet<num_t>(D, v);
+}
+
+// Whether a and b are the same point; dual numbers must also have the same
+// derivative
+template <typename num_t>
+bool same_point(const num_t& a, const num_t& b) {
+    return a == b;
+}
+
+template <typename T>
+bool same_point(const solver::dual<T>& a, const solver::dual<T>& b) {
+    return a.value() == b.value() && a.derivative() == b.derivative();
+}
+
+// Storage reused by the evaluations of H[D,d] in each thread, so that the
+// iterations of the Newton-Raphson method do not allocate. It is created
+// again when the precision changes.
+template <typename num_t>
+struct Workspace {
+    // A series kept for evaluations of H[D,d] with other d at the same point
+    struct Recent {
+        bool strong_field = false;
+        num_t f2;
+        // f[0]...f[n-1]
+        std::vector<num_t> fj;
+        int n = 0;
+    };
+
+    unsigned digits;
+    num_t f2;
+    Series<num_t> isolated, strong;
+    SeriesPolynomials::Workspace<num_t> polynomials;
+    ricpad::hankdet::Workspace<num_t> hankdet;
+    // The series of the last few points, and the slot to be replaced next
+    Recent recent[4];
+    int next = 0;
+
+    Workspace() :
+        digits(ricpad::precision<num_t>::get()),
+        isolated(num_t(0)), strong(num_t(0), true) {};
+};
+
+// Workspace of the calling thread for the current precision
+template <typename num_t>
+Workspace<num_t>& thread_workspace() {
+    static thread_local std::unique_ptr<Workspace<num_t>> ws;
+    if ( ! ws || ws->digits != ricpad::precision<num_t>::get() )
+        ws.reset(new Workspace<num_t>());
+
+    return *ws;
+}
+
+// f[0]...f[N] from the polynomials of the series, which are kept with a
+// variable precision and therefore only work with mpfr_float
+template <typename num_t>
+const num_t* polynomial_series(
+        SeriesPolynomials&, const int, const num_t&, 
+        SeriesPolynomials::Workspace<num_t>&
+        ) {
+    throw std::runtime_error(
+            "The polynomial series needs the dynamic backend.");
+}
+
+template <>
+inline const mpfr_float* polynomial_series<mpfr_float>(
+        SeriesPolynomials& polynomials, const int N, const mpfr_float& f2,
+        SeriesPolynomials::Workspace<mpfr_float>& ws
+        ) {
+    return polynomials.coefs<mpfr_float>(N, f2, ws).data();
+}
+
+template <>
+inline const dual_float* polynomial_series<dual_float>(
+        SeriesPolynomials& polynomials, const int N, const dual_float& f2,
+        SeriesPolynomials::Workspace<dual_float>& ws
+        ) {
+    return polynomials.coefs<dual_float>(N, f2, ws).data();
+}
+
+// The series f[0]...f[2*D+d] in which x/2 is the second coefficient, stored
+// in ws. It is obtained from polynomials if it is not null, and from the
+// recurrence otherwise. If Nshared > 0, the series goes up to f[Nshared] 
+// when that is longer, and it is taken from the recent series of ws, or 
+// kept among them, so that H[D,d] for several d at the same point needs a
+// single series.
+template <typename num_t>
+const num_t* hankel_series(
+        const bool strong_field, SeriesPolynomials* polynomials,
+        const int D, const int d, const num_t &x, Workspace<num_t>& ws,
+        const int Nshared = 0
+        ) {
+    const int N = std::max(2*D+d, Nshared);
+
+    ws.f2 = x;
+    ws.f2 /= 2;
+
+    if ( Nshared > 0 ) {
+        for ( const auto& r : ws.recent ) 
+            if ( r.n > N && r.strong_field == strong_field 
+                    && same_point(r.f2, ws.f2) ) 
+                return r.fj.data();
+    }
+
+    const num_t* c;
+
+    if ( polynomials ) {
+        c = polynomial_series<num_t>(*polynomials, N, ws.f2, ws.polynomials);
+    } else {
+        Series<num_t>& series = strong_field ? ws.strong : ws.isolated;
+        series.reset(ws.f2);
+        series.extend(N);
+        c = series.data();
+    }
+
+    if ( Nshared > 0 ) {
+        auto& r = ws.recent[ws.next];
+        ws.next = (ws.next + 1) % 4;
+
+        if ( int(r.fj.size()) <= N ) r.fj.resize(N+1);
+        std::copy(c, c + N+1, r.fj.begin());
+        r.n = N+1;
+        r.f2 = ws.f2;
+        r.strong_field = strong_field;
+    }
+
+    return c;
+}
+
+// H[D,d] as a function of x, where x/2 is the second coefficient of the
+// series. The time spent in each phase is added to phases if it is not null.
+// Nshared is passed to hankel_series.
+template <typename num_t>
+num_t hankel_function(
+        const bool strong_field, SeriesPolynomials* polynomials,
+        const HankelMethod &method, const int D, const int d, num_t &x,
+        stats::Phases* phases = nullptr, const int Nshared = 0
+        ) {
+    Workspace<num_t>& ws = thread_workspace<num_t>();
+
+    // The series, starting at f[d+1]
+    const num_t* c;
+
+    {
+        stats::Timer timer(phases ? &phases->series : nullptr);
+        c = hankel_series<num_t>(
+                strong_field, polynomials, D, d, x, ws, Nshared);
+    }
+    c += d+1;
+
+    stats::Timer timer(phases ? &phases->hankdet : nullptr);
+
+    if ( method.name == "dodgson" && ! method.pool )
+        return ricpad::hankdet::hankdet<num_t>(D, c, ws.hankdet);
+
+    std::vector<num_t> v(c, c + 2*D-1);
+    return hankel_determinant<num_t>(method, D, v);
+}
+
+// Whether y = H[D,d], computed by the Dodgson condensation in the calling 
+// thread, and the levels it came from are within the exponent range of 
+// num_t. Each level multiplies values of the previous one, which are larger
+// than those of the ones before it, so the squares of level D-1 must be in
+// range too. Always true for the types based on MPFR.
+template <typename num_t>
+bool in_range(const num_t& y, const int D) {
+    if ( ricpad::out_of_range(y) ) return false;
+
+    // Only the types with a limited range, which solve_fixed uses with 
+    // the serial Dodgson condensation alone, fill the levels checked here;
+    // for the others they may be empty or stale
+    if ( ! ricpad::limited_range<num_t>::value || D < 3 ) return true;
+
+    const std::vector<num_t>& m1 = thread_workspace<num_t>().hankdet.m1;
+    if ( m1.size() < 3 ) return true;
+
+    for ( int k = 0; k < 3; k++ )
+        if ( ricpad::square_out_of_range(m1[k]) ) return false;
+
+    return true;
+}
+
+// Decimal digits of a root x of H[D,d] lost to rounding errors, from the
+// running error bound of the Dodgson condensation. At the root itself the
+// relative error of H[D,d] is meaningless, so the bound is evaluated at
+// x + delta instead; there the error of H[D,d] amounts to that relative
+// error times delta in x.
+inline double hankel_loss(
+        const bool strong_field, SeriesPolynomials* polynomials,
+        const int D, const int d, const mpfr_float &x, const mpfr_float &delta
+        ) {
+    Workspace<mpfr_float>& ws = thread_workspace<mpfr_float>();
+    const mpfr_float* c = hankel_series<mpfr_float>(
+            strong_field, polynomials, D, d, mpfr_float(x + delta), ws);
+
+    double log2_error;
+    ricpad::hankdet::hankdet_error<mpfr_float>(
+            D, c + d+1, ws.hankdet, log2_error);
+
+    return log2_error*std::log10(2.) - double(log10(abs(x)/delta));
+}
+
+// Root of H[D,d] found by the solver, and what it cost
+struct Root {
+    mpfr_float x;
+    int iterations, evaluations;
+    // Wall time of the solve and time spent in each phase, in seconds
+    double time, time_series, time_hankdet;
+    // Whether x was taken from the result cache
+    bool cached;
+    // Digits of x lost to rounding errors, if known
+    double loss;
+};
+
+//------------------------------------------------------------------------------
+// Names of the iterations available to solve H[D,d] = 0
+inline const std::vector<std::pair<std::string, Solver::Method>>& methods() {
+    static const std::vector<std::pair<std::string, Solver::Method>> m = {
+        {"newton", Solver::Method::newton},
+        {"secant", Solver::Method::secant},
+        {"steffensen", Solver::Method::steffensen},
+        {"illinois", Solver::Method::illinois},
+        {"brent", Solver::Method::brent},
+        {"halley", Solver::Method::halley}
+    };
+
+    return m;
+}
+
+// A sweep over D for one equation, with the starting values of the adaptive
+// precision, tolerance and step size. The fields follow the command line
+// options of the same names.
+struct Job {
+    std::string mode = "isolated";
+    // -1 selects 3 for the isolated atom and 4 for the strong field
+    int d = -1;
+    int Dmin = 3, Dmax = -1, Dstep = 1;
+    std::string x0 = "-1.6", tol = "1E-10", h = "1E-20";
+    int ndigits = 40;
+    std::string derivative = "numeric";
+    std::string method = "newton";
+    int maxiter = 20;
+    int nr_start_digits = 0;
+    std::string series = "recurrence";
+    std::string precision_control = "growth";
+    // Either dynamic, for mpfr_float, or fixed, for the smallest of the 
+    // fixed_float types with at least ndigits digits
+    std::string backend = "dynamic";
+    // Other values of d solved at each D along with d, to cross-check its
+    // roots. The series at their common starting point is then computed 
+    // once for all of them.
+    std::vector<int> cross_d;
+    // Sequence acceleration of the roots, which seeds the next D, and the
+    // number of latest roots it uses
+    std::string accel = "none";
+    int accel_terms = 6;
+    // Number of D values solved at the same time
+    int sweep_threads = 1;
+    // File where the state of the sweep is kept, every checkpoint_every D
+    // values, and from which it resumes
+    std::string checkpoint;
+    int checkpoint_every = 1;
+    // If larger than 0, digits of the certified enclosure of each root
+    int certify = 0;
+
+    bool strong_field() const {return mode == "strong-field";};
+    bool exact_derivative() const {return derivative == "exact";};
+
+    // Length of the series shared by d and cross_d for D, or 0 if there is
+    // nothing to share
+    int shared_series(const int D) const {
+        if ( cross_d.empty() ) return 0;
+        return 2*D + std::max(d, *std::max_element(
+                    cross_d.begin(), cross_d.end()));
+    };
+
+    Solver::Method solver_method() const {
+        for ( const auto& m : methods() )
+            if ( m.first == method ) return m.second;
+
+        return Solver::Method::newton;
+    };
+
+    //--------------------------------------------------------------------------
+    // Set d if it is -1, and check the fields. Returns an empty string if
+    // they are valid, and the reason otherwise.
+    std::string validate() {
+        if ( mode != "isolated" && mode != "strong-field" )
+            return "Mode " + mode + " not available.";
+
+        if ( d == -1 ) d = strong_field() ? 4 : 3;
+
+        if ( d < 0 ) return "d should be at least 0.";
+        for ( int dc : cross_d ) 
+            if ( dc < 0 || dc == d ) 
+                return "cross-d should hold values of at least 0 other than "
+                    "d.";
+
+        if ( Dmin < 3 ) return "Dmin should be at least 3.";
+        if ( Dmax > -1 && Dmax < 3 ) return "Dmax should be at least 3.";
+        if ( Dstep < 1 ) return "Dstep should be at least 1.";
+        if ( ndigits < 15 ) return "ndigits should be at least 15.";
+        if ( maxiter < 1 ) return "nr-max-iter should be at least 1.";
+
+        if ( derivative != "numeric" && derivative != "exact" )
+            return "derivative should be either numeric or exact.";
+
+        if ( series != "recurrence" && series != "polynomial" )
+            return "series should be either recurrence or polynomial.";
+
+        if ( std::none_of(
+                    methods().begin(), methods().end(),
+                    [this] (const std::pair<std::string, Solver::Method>& m)
+                    -> bool {return m.first == method;}) )
+            return "method should be one of newton, secant, steffensen, "
+                "illinois, brent or halley.";
+
+        if ( nr_start_digits > 0 && solver_method() != Solver::Method::newton )
+            return "nr-start-digits needs the newton method.";
+
+        if ( backend != "dynamic" && backend != "fixed" )
+            return "backend should be either dynamic or fixed.";
+
+        if ( backend == "fixed" && series == "polynomial" )
+            return "The polynomial series needs the dynamic backend.";
+
+        if ( backend == "fixed" && nr_start_digits > 0 )
+            return "nr-start-digits needs the dynamic backend.";
+
+        if ( precision_control != "growth"
+                && precision_control != "error-bound" )
+            return "precision-control should be either growth or "
+                "error-bound.";
+
+        if ( accel != "none" && accel != "aitken" && accel != "richardson" 
+                && accel != "wynn" && accel != "levin" )
+            return "accel should be one of none, aitken, richardson, wynn "
+                "or levin.";
+
+        if ( accel_terms < 3 ) return "accel-terms should be at least 3.";
+        if ( sweep_threads < 1 ) return "sweep-threads should be at least 1.";
+        if ( checkpoint_every < 1 ) 
+            return "checkpoint-every should be at least 1.";
+        if ( certify < 0 ) return "certify should not be negative.";
+
+        // Without a per-thread default precision, the D values solved at
+        // the same time share it
+        const bool per_thread = ricpad::precision<mpfr_float>::per_thread;
+        if ( nr_start_digits > 0 && sweep_threads > 1 && ! per_thread )
+            return "nr-start-digits cannot be combined with sweep-threads "
+                "with this version of Boost, which lacks a per-thread "
+                "default precision.";
+
+        if ( certify > 0 && sweep_threads > 1 && ! per_thread )
+            return "certify cannot be combined with sweep-threads with this "
+                "version of Boost, which lacks a per-thread default "
+                "precision.";
+
+        if ( ! cross_d.empty() && sweep_threads > 1 )
+            return "cross-d cannot be combined with sweep-threads.";
+
+        for ( const std::string* s : {&x0, &tol, &h} ) {
+            try {
+                mpfr_float y(*s);
+            } catch ( const std::runtime_error& e ) {
+                return "Not a number: " + *s + ".";
+            }
+        }
+
+        return "";
+    };
+
+    //--------------------------------------------------------------------------
+    // Set the field named as the command line option key from value.
+    // Returns an empty string on success, and the reason otherwise.
+    std::string set(const std::string& key, const std::string& value) {
+        std::string* text =
+            key == "mode" ? &mode : key == "x0" ? &x0 :
+            key == "tol" ? &tol : key == "h" ? &h :
+            key == "derivative" ? &derivative : key == "method" ? &method :
+            key == "series" ? &series : key == "backend" ? &backend :
+            key == "precision-control" ? &precision_control : 
+            key == "accel" ? &accel : key == "checkpoint" ? &checkpoint :
+            nullptr;
+        int* number =
+            key == "d" ? &d : key == "Dmin" ? &Dmin : key == "Dmax" ? &Dmax :
+            key == "Dstep" ? &Dstep : key == "ndigits" ? &ndigits :
+            key == "nr-max-iter" ? &maxiter :
+            key == "nr-start-digits" ? &nr_start_digits : 
+            key == "accel-terms" ? &accel_terms :
+            key == "sweep-threads" ? &sweep_threads :
+            key == "checkpoint-every" ? &checkpoint_every :
+            key == "certify" ? &certify : nullptr;
+
+        if ( key == "cross-d" ) {
+            // Values separated by commas
+            std::istringstream in(value);
+            std::string item;
+            cross_d.clear();
+
+            while ( std::getline(in, item, ',') ) {
+                std::istringstream in_item(item);
+                int dc;
+                if ( ! (in_item >> dc) || ! in_item.eof() )
+                    return "Not an integer: " + item + ".";
+                cross_d.push_back(dc);
+            }
+        } else if ( text ) {
+            *text = value;
+        } else if ( number ) {
+            std::istringstream in(value);
+            if ( ! (in >> *number) || ! in.eof() )
+                return "Not an integer: " + value + ".";
+        } else {
+            return "Unknown field " + key + ".";
+        }
+
+        return "";
+    };
+
+    //--------------------------------------------------------------------------
+    // Set the fields given in line as key=value pairs separated by blanks.
+    // Returns an empty string on success, and the reason otherwise.
+    std::string parse(const std::string& line) {
+        std::istringstream in(line);
+        std::string item;
+
+        while ( in >> item ) {
+            const auto eq = item.find('=');
+            if ( eq == std::string::npos )
+                return "Expected key=value instead of " + item + ".";
+
+            std::string error = set(item.substr(0, eq), item.substr(eq+1));
+            if ( ! error.empty() ) return error;
+        }
+
+        return "";
+    };
+};
+
+// Root of H[D,d] for one of the cross_d values of a job
+struct CrossRoot {
+    int d;
+    // If false, the solver did not converge and root is not set
+    bool converged;
+    Root root;
+};
+
+// Result of Engine::certify
+struct Enclosure {
+    // Holds the root when certified is true
+    ricpad::interval x;
+    // Whether x is proven to hold exactly one root of H[D,d]
+    bool certified;
+    // Decimal digits of the root fixed by x
+    double digits;
+    int iterations;
+    // Digits of the endpoints in the end
+    int ndigits;
+};
+
+// A D value of a sweep, and the state of the sweep after it
+struct Step {
+    int D;
+    // If false, the solver did not converge and root is not set
+    bool converged;
+    Root root;
+    // Roots for the cross_d values of the job
+    std::vector<CrossRoot> cross;
+    // Distance to the previous root
+    mpfr_float dE;
+    // Estimate of the limit of the roots, if the job has an accel
+    mpfr_float xaccel;
+    // Enclosure of the root, if the job certifies them
+    Enclosure enclosure;
+    // Digits, tolerance and step size for the next D
+    int ndigits;
+    mpfr_float tol, h;
+};
+
+// A root of H[D,d] found by Engine::scan between the grid points a and b
+struct ScanRoot {
+    mpfr_float a, b;
+    // Whether H[D,d] changes sign between a and b. Otherwise |H[D,d]| comes
+    // close to zero there, and the root was sought from the point between
+    // them where it is smallest.
+    bool bracketed;
+    // If false, the solver did not converge to a root between a and b, and
+    // root is not set
+    bool converged;
+    Root root;
+};
+
+// Result of Engine::scan for one D
+struct Scan {
+    int D;
+    // Grid points whose sign of H[D,d] could not be told even with the full
+    // precision. Even when there are none, roots closer together than the
+    // grid spacing may have been missed.
+    int uncertain;
+    std::vector<ScanRoot> roots;
+};
+
+//------------------------------------------------------------------------------
+// Adjust the precision, tolerance and step size for the D values following
+// D, given the root found for D and its distance dE to the previous one
+inline void adapt(
+        const Job& job, const int D, const Root& root, const mpfr_float& dE,
+        mpfr_float& tol, mpfr_float& h, int& ndigits
+        ) {
+    int curr_ndigits = -int(floor(log10(dE)));
+    tol = mp::min(tol, dE/1e10);
+    h = tol*tol;
+
+    // The error bound is infinite when an entry of the condensation is
+    // exactly zero, and then the growth rule is used instead
+    if ( job.precision_control == "error-bound" && std::isfinite(root.loss) ) {
+        // The digits lost grow about linearly with D, and the remaining
+        // ones have to resolve tol, or h for the numeric derivative
+        const double loss = root.loss*(D+job.Dstep)/D;
+        const int needed = job.exact_derivative() ?
+            -int(floor(log10(tol))) : -int(floor(log10(h)));
+        ndigits = std::max(15, int(ceil(loss)) + needed + 10);
+    } else {
+        ndigits = std::max(4*curr_ndigits, ndigits);
+        if ( ! job.exact_derivative() )
+            ndigits = std::max(-2*int(floor(log10(h))), ndigits);
+    }
+}
+
+// Starting value for a D that has not been solved yet, extrapolated from the
+// roots found for the previous D values with Aitken's delta-squared process.
+// The last root is used instead when the extrapolation is not reliable.
+inline mpfr_float extrapolate_root(const std::vector<mpfr_float> &roots) {
+    int n = roots.size();
+
+    if ( n < 3 ) return roots.back();
+
+    mpfr_float d1 = roots[n-1] - roots[n-2];
+    mpfr_float d0 = roots[n-2] - roots[n-3];
+
+    if ( d1 == d0 ) return roots.back();
+
+    mpfr_float x = roots[n-1] - d1*d1/(d1 - d0);
+
+    if ( abs(x - roots[n-1]) > 10*abs(d1) ) return roots.back();
+
+    return x;
+}
+
+//------------------------------------------------------------------------------
+class Engine {
+    private:
+        // Polynomials for the isolated atom and strong field series, and
+        // the files where they are kept
+        std::unique_ptr<SeriesPolynomials> polynomials_[2];
+        std::string series_cache_[2];
+        std::mutex mutex_;
+
+        //----------------------------------------------------------------------
+        // Solve H[D,d] = 0 for job working with num_t, whose precision is 
+        // ndigits if it is variable. The root is returned as an mpfr_float
+        // with ndigits digits, along with the iterations and evaluations; 
+        // the rest of the fields are left for the caller. 
+        template <typename num_t>
+        Root solve_with(
+                const Job& job, const int D, SeriesPolynomials* p,
+                const int Nshared,
+                const mpfr_float &xstart, const mpfr_float &xsecond,
+                const int ndigits, const mpfr_float &tol, const mpfr_float &h,
+                stats::Phases& phases
+                ) {
+            typedef solver::dual<num_t> dual_t;
+            typedef solver::Solver<num_t, num_t> solver_t;
+
+            const bool strong_field = job.strong_field();
+            const int d = job.d;
+
+            // The series is only shared at the starting point, which is
+            // common to d and the cross_d values; the other points of each
+            // solve are its own, and neither extend the series to Nshared
+            // nor keep it among the recent ones
+            const num_t x0 = convert<num_t>(xstart, ndigits);
+
+            // The function for the Hankel determinants, and its
+            // counterpart on dual numbers for automatic differentiation. 
+            // Values that num_t cannot hold reliably raise 
+            // std::range_error.
+            std::function<num_t(num_t&)> f =
+                [&] ( num_t &x ) -> num_t {
+                    num_t y = hankel_function<num_t>(
+                            strong_field, p, hankdet, D, d, x, &phases,
+                            x == x0 ? Nshared : 0);
+                    if ( ! in_range(y, D) ) 
+                        throw std::range_error("H[D,d] is out of range");
+                    return y;
+                };
+            std::function<dual_t(dual_t&)> fd =
+                [&] ( dual_t &x ) -> dual_t {
+                    dual_t y = hankel_function<dual_t>(
+                            strong_field, p, hankdet, D, d, x, &phases,
+                            x.value() == x0 ? Nshared : 0);
+                    if ( ! in_range(y, D) ) 
+                        throw std::range_error("H[D,d] is out of range");
+                    return y;
+                };
+
+            // Only newton and halley use derivatives
+            const Solver::Method method = job.solver_method();
+            const bool use_fd = job.exact_derivative() && (
+                    method == Solver::Method::newton ||
+                    method == Solver::Method::halley );
+            solver_t s = use_fd ? solver_t(fd) : solver_t(f);
+            s.set_method(typename solver_t::Method(int(method)));
+            s.set_tol(convert<num_t>(tol, ndigits));
+            // Scale of the first step when xsecond == xstart
+            s.set_step(convert<num_t>(mpfr_float(sqrt(tol)), ndigits));
+            s.set_h(convert<num_t>(h, ndigits));
+            s.set_maxiter(job.maxiter);
+            s.set_pool(nr_pool);
+
+            if ( log ) {
+                s.set_log(ndigits);
+            }
+
+            num_t xroot = job.nr_start_digits > 0 ?
+                s.solve_escalating(
+                        convert<num_t>(xstart, ndigits), job.nr_start_digits) :
+                s.solve(
+                        convert<num_t>(xstart, ndigits),
+                        convert<num_t>(xsecond, ndigits));
+
+            return Root{
+                convert<mpfr_float>(xroot, ndigits),
+                s.iterations(), s.evaluations(), 0, 0, 0, false, 0};
+        };
+
+        // solve_with for the smallest of dd_real, qd_real and the 
+        // fixed_float types with at least ndigits digits, or for mpfr_float
+        // if there is none. H[D,d] soon leaves the exponent range of double
+        // as D grows, and then the smallest fixed_float with at least
+        // ndigits digits, starting with 50, is used instead. 
+        // dd_real and qd_real are only used with the serial Dodgson 
+        // condensation, whose levels are checked by in_range.
+        Root solve_fixed(
+                const Job& job, const int D, SeriesPolynomials* p,
+                const int Nshared,
+                const mpfr_float &xstart, const mpfr_float &xsecond,
+                const int ndigits, const mpfr_float &tol, const mpfr_float &h,
+                stats::Phases& phases
+                ) {
+            try {
+                if ( hankdet.name != "dodgson" || hankdet.pool ) 
+                    throw std::range_error("Only for the serial Dodgson "
+                            "condensation");
+                if ( ndigits <= 
+                        std::numeric_limits<ricpad::dd_real>::digits10 ) 
+                    return solve_with<ricpad::dd_real>(
+                            job, D, p, Nshared, xstart, xsecond, ndigits, 
+                            tol, h, phases);
+                if ( ndigits <= 
+                        std::numeric_limits<ricpad::qd_real>::digits10 ) 
+                    return solve_with<ricpad::qd_real>(
+                            job, D, p, Nshared, xstart, xsecond, ndigits, 
+                            tol, h, phases);
+            } catch ( const std::range_error& e ) {
+            }
+
+            if ( ndigits <= 50 ) 
+                return solve_with<fixed_float<50>>(
+                        job, D, p, Nshared, xstart, xsecond, ndigits, tol, h,
+                        phases);
+            if ( ndigits <= 100 ) 
+                return solve_with<fixed_float<100>>(
+                        job, D, p, Nshared, xstart, xsecond, ndigits, tol, h,
+                        phases);
+            if ( ndigits <= 250 ) 
+                return solve_with<fixed_float<250>>(
+                        job, D, p, Nshared, xstart, xsecond, ndigits, tol, h,
+                        phases);
+            if ( ndigits <= 500 ) 
+                return solve_with<fixed_float<500>>(
+                        job, D, p, Nshared, xstart, xsecond, ndigits, tol, h,
+                        phases);
+            if ( ndigits <= 1000 ) 
+                return solve_with<fixed_float<1000>>(
+                        job, D, p, Nshared, xstart, xsecond, ndigits, tol, h,
+                        phases);
+
+            return solve_with<mpfr_float>(
+                    job, D, p, Nshared, xstart, xsecond, ndigits, tol, h,
+                    phases);
+        };
+
+    public:
+        HankelMethod hankdet;
+        // Threads for the function evaluations of each iteration, besides
+        // the calling one
+        ricpad::ThreadPool* nr_pool = nullptr;
+        // Roots found by this and previous runs
+        checkpoint::ResultCache* result_cache = nullptr;
+        // Print each iteration of the solver
+        bool log = false;
+        // Where the sweeps record the cost of each D, if not null
+        stats::Writer* stats_writer = nullptr;
+
+        //----------------------------------------------------------------------
+        // Keep the polynomials of the given equation in path, loading them
+        // from it if it already holds them
+        void set_series_cache(bool strong_field, const std::string& path) {
+            series_cache_[strong_field] = path;
+            polynomials_[strong_field].reset();
+        };
+
+        // Polynomials of the given equation up to f[N], created and stored
+        // in the series cache as needed
+        SeriesPolynomials* polynomials(bool strong_field, int N) {
+            std::unique_ptr<SeriesPolynomials>& p = polynomials_[strong_field];
+            const std::string& path = series_cache_[strong_field];
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if ( ! p ) {
+                    p.reset(new SeriesPolynomials(strong_field));
+                    if ( ! path.empty() ) p->load(path);
+                }
+            }
+
+            if ( p->extend(N) && ! path.empty() && ! p->save(path) )
+                std::cerr << "Could not write " << path << std::endl;
+
+            return p.get();
+        };
+
+        //----------------------------------------------------------------------
+        // Solve H[D,d] = 0 for job in the calling thread, starting from
+        // xstart (and xsecond for the methods that need two points) and
+        // working with ndigits digits. Throws std::runtime_error if the
+        // method does not converge.
+        Root solve(
+                const Job& job, const int D,
+                const mpfr_float &xstart, const mpfr_float &xsecond,
+                const int ndigits, const mpfr_float &tol, const mpfr_float &h
+                ) {
+            ricpad::precision<mpfr_float>::set(ndigits);
+
+            const bool strong_field = job.strong_field();
+            const int d = job.d, Nshared = job.shared_series(D);
+            SeriesPolynomials* p = job.series == "polynomial" ?
+                polynomials(strong_field, std::max(2*D+d, Nshared)) : 
+                nullptr;
+
+            // Digits of the root lost to rounding, for the precision
+            // controller
+            auto loss = [&] (const mpfr_float &xroot) -> double {
+                if ( job.precision_control != "error-bound" ) return 0;
+                return hankel_loss(
+                        strong_field, p, D, d, xroot,
+                        mpfr_float(sqrt(tol), ndigits));
+            };
+
+            mpfr_float xcached;
+            if ( result_cache
+                    && result_cache->find(job.mode, d, D, ndigits, xcached) ) {
+                xcached.precision(ndigits);
+                return Root{xcached, 0, 0, 0, 0, 0, true, loss(xcached)};
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            stats::Phases phases;
+
+            Root root = job.backend == "fixed" ?
+                solve_fixed(
+                        job, D, p, Nshared, xstart, xsecond, ndigits, tol, h,
+                        phases) :
+                solve_with<mpfr_float>(
+                        job, D, p, Nshared, xstart, xsecond, ndigits, tol, h,
+                        phases);
+            const mpfr_float& xroot = root.x;
+
+            if ( result_cache
+                    && ! result_cache->insert(job.mode, d, D, ndigits, xroot) )
+                std::cerr << "Could not write the result cache" << std::endl;
+
+            root.time = stats::seconds_since(start);
+            root.time_series = 1e-9*phases.series;
+            root.time_hankdet = 1e-9*phases.hankdet;
+            root.loss = loss(xroot);
+
+            return root;
+        };
+
+        //----------------------------------------------------------------------
+        // Solve H[D,d] = 0 for each of the cross_d values of job, starting 
+        // from the same xstart as d, so that the series of the first 
+        // evaluations are shared with it and with each other
+        std::vector<CrossRoot> cross_check(
+                const Job& job, const int D, const mpfr_float &xstart,
+                const int ndigits, const mpfr_float &tol, const mpfr_float &h
+                ) {
+            std::vector<CrossRoot> cross;
+            Job j = job;
+
+            for ( int dc : job.cross_d ) {
+                CrossRoot c;
+                c.d = j.d = dc;
+
+                try {
+                    c.root = solve(j, D, xstart, xstart, ndigits, tol, h);
+                    c.converged = true;
+                } catch ( const std::runtime_error& e ) {
+                    c.converged = false;
+                }
+
+                cross.push_back(c);
+            }
+
+            return cross;
+        };
+
+        //----------------------------------------------------------------------
+        // Look for all the roots of H[D,d] for job with x between xmin and 
+        // xmax. H[D,d] is evaluated at points values of x evenly spaced in 
+        // that interval with scan_digits digits, along with the running error
+        // bound of the Dodgson condensation, and the points where the bound
+        // does not fix the sign are evaluated again with ndigits digits. 
+        // Each sign change between consecutive points of known sign is then
+        // refined with Brent's method, and each local minimum of |H[D,d]| 
+        // without a sign change, which may hide two close roots, with the
+        // method of job from that minimum, followed by Brent's method for
+        // the other root of the pair. Pairs of roots that leave no minimum
+        // on the grid are missed, so the scan is not exhaustive: more
+        // points make it less likely. The evaluations and the 
+        // refinements are split among the threads of pool if it is not null.
+        // The refinements work with ndigits digits, which are left as the
+        // precision of the calling thread.
+        Scan scan(
+                const Job& job, const int D, 
+                const mpfr_float &xmin, const mpfr_float &xmax, 
+                const int points, const int scan_digits, const int ndigits,
+                const mpfr_float &tol, const mpfr_float &h,
+                ricpad::ThreadPool* pool = nullptr
+                ) {
+            typedef ricpad::precision<mpfr_float> precision;
+
+            const bool strong_field = job.strong_field();
+            const int d = job.d;
+            SeriesPolynomials* p = job.series == "polynomial" ?
+                polynomials(strong_field, 2*D+d) : nullptr;
+
+            // Run f(0)...f(n-1) with digits digits, split among the threads
+            // of pool
+            auto parallel = [pool] (
+                    const int n, const unsigned digits, 
+                    const std::function<void(int)>& f) {
+                precision::set(digits);
+
+                if ( ! pool || n < 2 ) {
+                    for ( int k = 0; k < n; k++ ) f(k);
+                    return;
+                }
+
+                const int nchunks = std::min(n, 4*pool->size());
+                std::vector<std::future<void>> tasks;
+                for ( int c = 0; c < nchunks; c++ ) {
+                    const int kmin = (c*n)/nchunks, kmax = ((c+1)*n)/nchunks;
+                    tasks.push_back(pool->submit([&f, kmin, kmax, digits] {
+                        precision::set(digits);
+                        for ( int k = kmin; k < kmax; k++ ) f(k);
+                    }));
+                }
+                for ( auto& t : tasks ) t.get();
+            };
+
+            // Grid point k with the precision of the calling thread
+            auto grid = [&] (const int k) -> mpfr_float {
+                return xmin + (xmax - xmin)*k/(points-1);
+            };
+
+            // H[D,d] at the points and their signs, or 0 where unknown
+            std::vector<mpfr_float> H(points);
+            std::vector<int> sign(points, 0);
+
+            // H[D,d] at x with the precision of the calling thread, left in
+            // Hx, and its sign, or 0 if the rounding errors hide it
+            auto value = [&] (const mpfr_float& x, mpfr_float& Hx) -> int {
+                Workspace<mpfr_float>& ws = thread_workspace<mpfr_float>();
+                const unsigned digits = precision::get();
+                const mpfr_float* c = hankel_series<mpfr_float>(
+                        strong_field, p, D, d, x, ws);
+
+                double log2_error;
+                Hx = ricpad::hankdet::hankdet_error<mpfr_float>(
+                        D, c + d+1, ws.hankdet, log2_error);
+
+                // At least one digit of H[D,d] is left
+                if ( Hx == 0 || log2_error*std::log10(2.) >= digits - 1 )
+                    return 0;
+                return Hx > 0 ? 1 : -1;
+            };
+
+            auto evaluate = [&] (const int k) {
+                sign[k] = value(grid(k), H[k]);
+            };
+
+            parallel(points, scan_digits, evaluate);
+
+            std::vector<int> unknown;
+            for ( int k = 0; k < points; k++ ) 
+                if ( sign[k] == 0 ) unknown.push_back(k);
+            parallel(unknown.size(), ndigits, [&] (const int k) {
+                evaluate(unknown[k]);
+            });
+
+            Scan scan;
+            scan.D = D;
+            scan.uncertain = std::count(sign.begin(), sign.end(), 0);
+
+            // Grid points around each candidate and where its refinement 
+            // starts
+            struct Candidate {
+                int a, b, start;
+                bool bracketed;
+            };
+            std::vector<Candidate> candidates;
+
+            // Across a run of points of unknown sign, either a sign change
+            // or a possible pair of roots
+            for ( int k = 0, last = -1; k < points; k++ ) {
+                if ( sign[k] == 0 ) continue;
+
+                if ( last >= 0 && sign[k] != sign[last] )
+                    candidates.push_back(Candidate{last, k, last, true});
+                else if ( last >= 0 && k - last > 1 )
+                    candidates.push_back(
+                            Candidate{last, k, (last+k)/2, false});
+
+                last = k;
+            }
+
+            for ( int k = 1; k+1 < points; k++ ) {
+                if ( sign[k] == 0 || sign[k-1] != sign[k] 
+                        || sign[k+1] != sign[k] ) continue;
+                if ( abs(H[k]) < abs(H[k-1]) && abs(H[k]) < abs(H[k+1]) )
+                    candidates.push_back(Candidate{k-1, k+1, k, false});
+            }
+
+            std::sort(candidates.begin(), candidates.end(), 
+                    [] (const Candidate& u, const Candidate& v) -> bool {
+                        return u.a < v.a;
+                    });
+
+            // The refinements, and the second roots found next to those 
+            // refined from a minimum
+            scan.roots.resize(candidates.size());
+            std::vector<ScanRoot> partners(candidates.size());
+            std::vector<char> partnered(candidates.size(), false);
+            Job brent = job;
+            brent.method = "brent";
+            brent.nr_start_digits = 0;
+
+            parallel(candidates.size(), ndigits, [&] (const int k) {
+                const Candidate& c = candidates[k];
+                ScanRoot& r = scan.roots[k];
+                stats::Phases phases;
+
+                r.a = grid(c.a);
+                r.b = grid(c.b);
+                r.bracketed = c.bracketed;
+
+                try {
+                    r.root = c.bracketed ?
+                        solve_with<mpfr_float>(
+                                brent, D, p, 0, r.a, r.b, ndigits, tol, h,
+                                phases) :
+                        solve_with<mpfr_float>(
+                                job, D, p, 0, grid(c.start), r.b, ndigits, 
+                                tol, h, phases);
+                    r.converged = r.root.x >= r.a && r.root.x <= r.b;
+                } catch ( const std::runtime_error& e ) {
+                    r.converged = false;
+                }
+
+                if ( c.bracketed || ! r.converged ) return;
+
+                // H[D,d] has the same sign at a and b, so a simple root 
+                // between them has a second one on the side where H[D,d] 
+                // takes the opposite sign next to it, found with Brent's
+                // method from there. Roots closer than delta are missed.
+                const mpfr_float& x = r.root.x;
+                const mpfr_float delta = 100*tol*max(mpfr_float(1), abs(x));
+                mpfr_float Hy;
+
+                for ( const int side : {1, -1} ) {
+                    const mpfr_float y = x + side*delta;
+                    if ( y <= r.a || y >= r.b ) continue;
+                    if ( value(y, Hy) != -sign[c.a] ) continue;
+
+                    ScanRoot& s = partners[k];
+                    s.a = side > 0 ? y : r.a;
+                    s.b = side > 0 ? r.b : y;
+                    s.bracketed = true;
+                    partnered[k] = true;
+
+                    try {
+                        s.root = solve_with<mpfr_float>(
+                                brent, D, p, 0, s.a, s.b, ndigits, tol, h,
+                                phases);
+                        s.converged = s.root.x >= s.a && s.root.x <= s.b;
+                    } catch ( const std::runtime_error& e ) {
+                        s.converged = false;
+                    }
+                    break;
+                }
+            });
+
+            for ( int k = 0; k < int(candidates.size()); k++ )
+                if ( partnered[k] ) scan.roots.push_back(partners[k]);
+
+            // Drop the roots found from a minimum that were also bracketed
+            std::vector<ScanRoot> roots;
+            for ( const ScanRoot& r : scan.roots ) {
+                bool found = false;
+                for ( const ScanRoot& s : scan.roots ) 
+                    if ( ! r.bracketed && r.converged && s.bracketed 
+                            && s.converged 
+                            && abs(s.root.x - r.root.x) <= 10*tol )
+                        found = true;
+                if ( ! found ) roots.push_back(r);
+            }
+            std::stable_sort(roots.begin(), roots.end(), 
+                    [] (const ScanRoot& u, const ScanRoot& v) -> bool {
+                        return u.a < v.a;
+                    });
+            scan.roots = std::move(roots);
+
+            return scan;
+        };
+
+        //----------------------------------------------------------------------
+        // Rigorous enclosure of the root of H[D,d] for job close to x, with
+        // the interval Newton method: for an interval X = [a, b] with 
+        // midpoint m,
+        //
+        //     N(X) = m - H(m)/H'(X)
+        //
+        // holds every root in X, and if N(X) lies in the interior of X and
+        // the enclosure of H'(X) excludes zero, X holds exactly one root. 
+        // H and H' are evaluated in interval arithmetic through the 
+        // recurrence of the series and the serial Dodgson condensation, 
+        // H' on dual numbers. The first X is centred on x, and is widened 
+        // until the proof succeeds; after it, X is replaced by its 
+        // intersection with N(X), which shrinks it quadratically until its
+        // width is below 10^-digits relative to x. When the rounding errors
+        // stop the shrinking first, the precision of the endpoints is
+        // doubled, up to four times. The precision of the calling thread is
+        // restored at the end.
+        Enclosure certify(
+                const Job& job, const int D, const mpfr_float &x, 
+                const int digits
+                ) {
+            typedef ricpad::interval interval;
+            typedef solver::dual<interval> dual_t;
+            typedef ricpad::precision<mpfr_float> precision;
+
+            const unsigned saved = precision::get();
+            const bool strong_field = job.strong_field();
+            const int d = job.d, maxiter = 40, max_doublings = 4;
+
+            auto H = [&] (const interval& X) -> interval {
+                Workspace<interval>& ws = thread_workspace<interval>();
+                const interval* c = hankel_series<interval>(
+                        strong_field, nullptr, D, d, X, ws);
+                return ricpad::hankdet::hankdet<interval>(
+                        D, c + d+1, ws.hankdet);
+            };
+            auto dH = [&] (const interval& X) -> interval {
+                Workspace<dual_t>& ws = thread_workspace<dual_t>();
+                const dual_t* c = hankel_series<dual_t>(
+                        strong_field, nullptr, D, d, dual_t(X, interval(1)), 
+                        ws);
+                return ricpad::hankdet::hankdet<dual_t>(
+                        D, c + d+1, ws.hankdet).derivative();
+            };
+
+            unsigned wp = std::max<unsigned>(x.precision(), digits + 20);
+            precision::set(wp);
+
+            Enclosure e{interval(x), false, 0, 0, int(wp)};
+            const mpfr_float target = abs(x)*pow(mpfr_float(10), -digits);
+            int doublings = 0;
+
+            try {
+                // The first radius is ten Newton steps from x, and at least
+                // the target width
+                mpfr_float r = abs(
+                        H(e.x).midpoint()/dH(e.x).midpoint());
+                r = mp::max(mpfr_float(10*r), target);
+                interval X(mpfr_float(x - r), mpfr_float(x + r)), N;
+
+                while ( e.iterations < maxiter ) {
+                    e.iterations++;
+
+                    const interval m(X.midpoint());
+                    const interval dHX = dH(X);
+
+                    // The rounding errors are as large as H'
+                    if ( dHX.contains_zero() ) {
+                        if ( ++doublings > max_doublings ) break;
+                        precision::set(wp *= 2);
+                        X.precision(wp);
+                        continue;
+                    }
+
+                    N = m;
+                    N -= H(m)/dHX;
+
+                    if ( ! e.certified ) {
+                        if ( N.interior(X) ) {
+                            e.certified = true;
+                            X = N;
+                        } else {
+                            // Epsilon-inflation: N widened to twice its
+                            // width around its midpoint
+                            const mpfr_float c = N.midpoint(), 
+                                w = N.width() + target;
+                            X = interval(
+                                    mpfr_float(c - w), mpfr_float(c + w));
+                        }
+                    } else {
+                        const mpfr_float before = X.width();
+                        if ( ! ricpad::intersect(N, X, X) ) {
+                            // Cannot happen in exact arithmetic
+                            e.certified = false;
+                            break;
+                        }
+
+                        // No progress: more digits are needed
+                        if ( X.width() > target && X.width() > before/2 ) {
+                            if ( ++doublings > max_doublings ) break;
+                            precision::set(wp *= 2);
+                            X.precision(wp);
+                        }
+                    }
+
+                    if ( e.certified ) e.x = X;
+                    if ( e.certified && X.width() <= target ) break;
+                }
+            } catch ( const std::runtime_error& err ) {
+                // A level of the condensation contains zero
+            }
+
+            if ( e.certified ) 
+                e.digits = -double(log10(e.x.width()/abs(x)));
+            e.ndigits = wp;
+
+            precision::set(saved);
+            return e;
+        };
+
+        //----------------------------------------------------------------------
+        // Read the checkpoint of job, which must have been validated, into 
+        // state. Returns false if job has no checkpoint or its file does not
+        // exist yet. Throws std::runtime_error if the file cannot be read or
+        // holds a sweep of another mode or d.
+        static bool resume(const Job& job, checkpoint::SweepState& state) {
+            if ( job.checkpoint.empty() || ! state.load(job.checkpoint) ) 
+                return false;
+
+            if ( state.mode != job.mode || state.d != job.d ) {
+                throw std::runtime_error(
+                    "The checkpoint in " + job.checkpoint + " is for mode " +
+                    state.mode + " and d = " + std::to_string(state.d) + ".");
+            }
+
+            return true;
+        };
+
+        //----------------------------------------------------------------------
+        // Run the sweep of job from Dmin to Dmax, passing each D to out in
+        // order of D as soon as it is done. Each D starts from the root of
+        // the previous one, or from the estimate of the accel of job. With
+        // sweep_threads larger than 1, that many D values are solved at the
+        // same time from roots extrapolated from the previous ones, and 
+        // solved again from the last root if the result is not consistent
+        // with them.
+        //
+        // The state of the sweep is written to the checkpoint of job as it
+        // advances, and the sweep resumes after the last D in it if it
+        // exists. The cost of each D is recorded in stats_writer if it is
+        // not null. Throws std::runtime_error if job is not valid, its 
+        // checkpoint cannot be resumed, or the solver fails for three D 
+        // values.
+        void sweep(Job job, const std::function<void(const Step&)>& out) {
+            typedef ricpad::precision<mpfr_float> precision;
+
+            std::string error = job.validate();
+            if ( ! error.empty() ) throw std::runtime_error(error);
+
+            const bool accel = job.accel != "none";
+            int Dmin = job.Dmin, ndigits = job.ndigits, nfailed = 0;
+            precision::set(ndigits);
+
+            mpfr_float x(job.x0), xold, xaccel, dE, tol(job.tol), h(job.h);
+
+            // Roots found so far, in order of D
+            std::vector<mpfr_float> roots;
+            std::vector<int> roots_D;
+
+            // Estimate the limit of the roots with the accel of job, from 
+            // the last accel_terms of them
+            auto accelerate = [&] () -> mpfr_float {
+                const int n = roots.size(), m = std::min(n, job.accel_terms);
+                if ( m < 3 ) return roots.back();
+
+                std::vector<mpfr_float> s(roots.end() - m, roots.end()), y;
+
+                if ( job.accel == "aitken" ) 
+                    return ricpad::extrapolation::aitken(s);
+                if ( job.accel == "wynn" ) 
+                    return ricpad::extrapolation::wynn(s);
+                if ( job.accel == "levin" ) 
+                    return ricpad::extrapolation::levin(s);
+
+                for ( int k = n - m; k < n; k++ ) 
+                    y.push_back(mpfr_float(1)/roots_D[k]);
+                return ricpad::extrapolation::richardson(s, y);
+            };
+
+            // Starting point for the next D: the accelerated estimate, 
+            // unless it is farther from the last root than the last two 
+            // roots are from each other
+            auto seed = [&] () -> mpfr_float {
+                if ( ! accel || roots.size() < 2 ) return x;
+                if ( abs(xaccel - x) > dE ) return x;
+
+                return xaccel;
+            };
+
+            // Second starting point for a solve that starts from xstart: 
+            // the last root that differs from it, if any
+            auto second_point = [&] (const mpfr_float &xstart) -> mpfr_float {
+                for ( int n = roots.size()-1; n >= 0; n-- ) 
+                    if ( roots[n] != xstart ) return roots[n];
+
+                return xstart;
+            };
+
+            checkpoint::SweepState state;
+            if ( resume(job, state) ) {
+                Dmin = state.D + job.Dstep;
+                nfailed = state.nfailed;
+                ndigits = state.ndigits;
+                x = state.x;
+                xold = state.xold;
+                dE = state.dE;
+                tol = state.tol;
+                h = state.h;
+                roots = state.roots;
+                roots_D = state.roots_D;
+                if ( accel && ! roots.empty() ) xaccel = accelerate();
+
+                precision::set(ndigits);
+            }
+
+            // Write the checkpoint after D, once every checkpoint_every D
+            // values
+            int unsaved = 0;
+            auto save_checkpoint = [&] (const int D) {
+                if ( job.checkpoint.empty() 
+                        || ++unsaved < job.checkpoint_every ) return;
+                unsaved = 0;
+
+                state.mode = job.mode;
+                state.d = job.d;
+                state.D = D;
+                state.nfailed = nfailed;
+                state.ndigits = ndigits;
+                state.x = x;
+                state.xold = xold;
+                state.dE = dE;
+                state.tol = tol;
+                state.h = h;
+                state.roots = roots;
+                state.roots_D = roots_D;
+
+                if ( ! state.save(job.checkpoint) ) 
+                    std::cerr << "Could not write " << job.checkpoint 
+                        << std::endl;
+            };
+
+            // Record the cost of step in stats_writer, if any. time is the
+            // time of the failed solve if step did not converge.
+            auto record = [&] (const Step& step, const double time) {
+                if ( ! stats_writer ) return;
+
+                stats::Record r;
+                r.mode = job.mode;
+                r.d = job.d;
+                r.D = step.D;
+
+                if ( step.converged ) {
+                    r.ndigits = step.root.x.precision();
+                    r.iterations = step.root.iterations;
+                    r.evaluations = step.root.evaluations;
+                    r.total = step.root.time;
+                    r.series = step.root.time_series;
+                    r.hankdet = step.root.time_hankdet;
+                    r.cached = step.root.cached;
+                    r.x = x.str(ndigits);
+                    r.dE = dE.str(4);
+                } else {
+                    r.ndigits = ndigits;
+                    r.total = time;
+                    r.failed = true;
+                }
+
+                stats_writer->write(r);
+            };
+
+            // Accept the root of step as the one for its D, adjust the
+            // precision, tolerance and step size for the following D values,
+            // and pass it to out
+            auto accept = [&] (Step& step) {
+                xold = x;
+                x = step.root.x;
+                roots.push_back(x);
+                roots_D.push_back(step.D);
+                if ( accel ) xaccel = accelerate();
+
+                dE = abs(x - xold);
+                adapt(job, step.D, step.root, dE, tol, h, ndigits);
+
+                step.converged = true;
+                step.dE = dE;
+                step.xaccel = xaccel;
+                step.ndigits = ndigits;
+                step.tol = tol;
+                step.h = h;
+                if ( job.certify > 0 ) 
+                    step.enclosure = certify(job, step.D, x, job.certify);
+
+                record(step, 0);
+                save_checkpoint(step.D);
+                out(step);
+            };
+
+            // Count step as failed after time seconds and pass it to out
+            auto fail = [&] (Step& step, const double time) {
+                nfailed += 1;
+
+                step.converged = false;
+                step.ndigits = ndigits;
+                step.tol = tol;
+                step.h = h;
+
+                record(step, time);
+                save_checkpoint(step.D);
+                out(step);
+
+                if ( nfailed >= 3 ) {
+                    throw std::runtime_error(
+                        "The solver failed to converge for " +
+                        std::to_string(nfailed) + " D values.");
+                }
+            };
+
+            if ( job.sweep_threads == 1 ) {
+                for ( int D = Dmin; job.Dmax < 0 || D <= job.Dmax; 
+                        D += job.Dstep ) {
+                    Step step;
+                    step.D = D;
+
+                    const mpfr_float xstart = seed();
+                    // Solved with the precision of d, before accept adjusts
+                    // it
+                    step.cross = cross_check(job, D, xstart, ndigits, tol, h);
+                    const auto start = std::chrono::steady_clock::now();
+
+                    try {
+                        step.root = solve(
+                                job, D, xstart, second_point(xstart), 
+                                ndigits, tol, h);
+                    } catch ( const std::runtime_error& e ) {
+                        fail(step, stats::seconds_since(start));
+                        continue;
+                    }
+
+                    accept(step);
+                    precision::set(ndigits);
+                }
+
+                return;
+            }
+
+            //------------------------------------------------------------------
+            // Parallel sweep: up to sweep_threads D values are solved at the 
+            // same time, and their results are processed in order of D. 
+
+            // Without a per-thread default precision in Boost, all the 
+            // computations running at a given time must share the 
+            // precision, so the state of the sweep is kept at the current
+            // precision too.
+            const bool per_thread = precision::per_thread;
+            auto set_precision = [&] (const int ndigits) {
+                precision::set(ndigits);
+                for ( mpfr_float* y : {&x, &xold, &xaccel, &dE, &tol, &h} ) 
+                    y->precision(ndigits);
+                for ( mpfr_float &y : roots ) y.precision(ndigits);
+            };
+            set_precision(ndigits);
+
+            // A root is consistent with the previous ones if it is not 
+            // farther from the last one than twice the distance between the
+            // last two. Otherwise it may belong to a different branch of 
+            // roots than the one followed by the sequential sweep.
+            auto consistent = [&] (const mpfr_float &xnew) -> bool {
+                int n = roots.size();
+                if ( n < 2 ) return true;
+
+                return abs(xnew - x) <= 2*abs(roots[n-1] - roots[n-2]);
+            };
+
+            // A D value being solved by the pool
+            struct Pending {
+                int D, ndigits;
+                std::future<Root> root;
+            };
+
+            std::deque<Pending> pending;
+            ricpad::ThreadPool pool(job.sweep_threads);
+            int Dnext = Dmin;
+
+            while ( true ) {
+                // Launch solves for the next D values
+                while ( int(pending.size()) < job.sweep_threads 
+                        && ( job.Dmax < 0 || Dnext <= job.Dmax ) ) {
+                    if ( ! per_thread && ! pending.empty() 
+                            && pending.back().ndigits != ndigits ) break;
+                    if ( ! per_thread && pending.empty() ) 
+                        set_precision(ndigits);
+
+                    const mpfr_float xstart = roots.empty() ? x : 
+                        accel ? seed() : extrapolate_root(roots);
+                    const mpfr_float xsecond = second_point(xstart);
+                    const int Djob = Dnext, ndigits_job = ndigits;
+                    const mpfr_float tol_job(tol), h_job(h);
+
+                    pending.push_back(Pending{Djob, ndigits_job, pool.submit(
+                        [this, &job, Djob, xstart, xsecond, ndigits_job,
+                                tol_job, h_job] () -> Root {
+                            return solve(
+                                job, Djob, xstart, xsecond, ndigits_job, 
+                                tol_job, h_job);
+                        })});
+
+                    Dnext += job.Dstep;
+                }
+
+                if ( pending.empty() ) break;
+
+                Pending next = std::move(pending.front());
+                pending.pop_front();
+
+                Step step;
+                step.D = next.D;
+                bool ok = true;
+                // Start of the last solve, for the stats of a failure
+                auto start = std::chrono::steady_clock::now();
+
+                try {
+                    step.root = next.root.get();
+                } catch ( const std::runtime_error& e ) {
+                    ok = false;
+                }
+
+                // Solve again starting from the last root if the solve 
+                // failed, used less digits than now required, or gave an 
+                // inconsistent root
+                if ( ! ok || next.ndigits < ndigits 
+                        || ! consistent(step.root.x) ) {
+                    if ( ! per_thread ) {
+                        for ( Pending &p : pending ) p.root.wait();
+                        set_precision(ndigits);
+                    }
+
+                    const mpfr_float xstart = 
+                        ok && consistent(step.root.x) ? step.root.x : x;
+                    start = std::chrono::steady_clock::now();
+
+                    try {
+                        step.root = solve(
+                                job, next.D, xstart, second_point(xstart), 
+                                ndigits, tol, h);
+                        ok = true;
+                    } catch ( const std::runtime_error& e ) {
+                        ok = false;
+                    }
+                }
+
+                if ( ok ) {
+                    accept(step);
+                } else {
+                    fail(step, stats::seconds_since(start));
+                }
+            }
+        };
+
+        //----------------------------------------------------------------------
+        // Run the sweeps of jobs one after the other, since the default
+        // precision of mpfr_float may be shared by all threads. Each D is
+        // passed to out along with the index of its job; the reason of the
+        // failure of a job, if any, is stored in the same position of the
+        // returned vector.
+        std::vector<std::string> run(
+                const std::vector<Job>& jobs,
+                const std::function<void(int, const Step&)>& out
+                ) {
+            std::vector<std::string> errors(jobs.size());
+
+            for ( int k = 0; k < int(jobs.size()); k++ ) {
+                try {
+                    sweep(jobs[k], [&out, k] (const Step& step) {
+                        out(k, step);
+                    });
+                } catch ( const std::runtime_error& e ) {
+                    errors[k] = e.what();
+                }
+            }
+
+            return errors;
+        };
+};
+
+} // namespace
+#endif
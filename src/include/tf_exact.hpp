@@ -0,0 +1,338 @@
+#ifndef TF_EXACT_HPP
+#define TF_EXACT_HPP
+
+#include <vector>
+#include <future>
+#include <algorithm>
+#include <boost/multiprecision/gmp.hpp>
+#include <boost/multiprecision/mpfr.hpp>
+
+#include <ricpad/aberth.hpp>
+#include <ricpad/modular.hpp>
+#include <ricpad/thread_pool.hpp>
+#include <tf_polynomials.hpp>
+
+// H[D,d] as an exact polynomial in x, the slope at the origin, obtained from
+// its values modulo many primes. For each prime p the series is run with
+// x = 0, 1, 2, ... modulo p, the determinant is found by elimination modulo
+// p, and the values are interpolated; the residues of the coefficients for
+// all the primes are then combined by Chinese remaindering, and the rational
+// coefficients recovered by rational reconstruction.
+namespace exact {
+
+using ricpad::modular::word;
+typedef SeriesPolynomials::Polynomial Polynomial;
+
+//------------------------------------------------------------------------------
+// Upper bound for the degree of H[D,d] in x. Each f[j] has degree at most
+// j/2 in x, and the degrees of the coefficients in any product of the
+// determinant add up to at most D*(D+d)/2.
+inline int hankel_degree(const int D, const int d) {
+    return D*(D+d)/2;
+}
+
+// Series f[0]...f[N] modulo p at x, with the recurrence and the symmetric
+// form of Series in tf.hpp. inverses holds the inverses of j*(j-2) modulo
+// p for 3 <= j <= N, and g is scratch storage.
+inline void series(
+        const bool strong_field, const int N, const word x, const word p,
+        const std::vector<word>& inverses, std::vector<word>& f,
+        std::vector<word>& g
+        ) {
+    using namespace ricpad::modular;
+
+    const word half = inverse(2, p);
+    f.assign(N+1, 0);
+    g.assign(N+1, 0);
+
+    f[0] = 1;
+    if ( N >= 2 ) f[2] = mul(x, half, p);
+
+    // g[k] = sum_l f[l]*f[k-l]
+    auto convolution = [&] (const int k) {
+        word s = 0;
+        for ( int l = 0; 2*l < k; l++ ) s = add(s, mul(f[l], f[k-l], p), p);
+        s = add(s, s, p);
+        if ( k % 2 == 0 ) s = add(s, mul(f[k/2], f[k/2], p), p);
+        g[k] = s;
+    };
+
+    if ( ! strong_field )
+        for ( int k = 0; k < 3; k++ ) convolution(k);
+
+    for ( int j = strong_field ? 4 : 3; j <= N; j++ ) {
+        // 2*(sum_k g[k]*f[j-k-3] or f[j-5])/(j*(j-2))
+        word t = 0;
+        if ( strong_field ) {
+            if ( j > 4 ) t = f[j-5];
+        } else {
+            for ( int k = 0; k < j-2; k++ )
+                t = add(t, mul(g[k], f[j-k-3], p), p);
+        }
+        t = mul(add(t, t, p), inverses[j], p);
+
+        // -S/2
+        word s = 0;
+        for ( int m = 1; 2*m < j; m++ ) s = add(s, mul(f[m], f[j-m], p), p);
+        if ( j % 2 == 0 ) s = add(s, mul(mul(f[j/2], f[j/2], p), half, p), p);
+
+        f[j] = sub(t, s, p);
+        if ( ! strong_field ) convolution(j);
+    }
+}
+
+// Residues modulo p of the coefficients of H[D,d] in x, lowest degree first,
+// up to the bound of hankel_degree
+inline std::vector<word> hankel_residues(
+        const bool strong_field, const int D, const int d, const word p
+        ) {
+    using namespace ricpad::modular;
+
+    const int N = 2*D+d, n = hankel_degree(D, d) + 1;
+
+    std::vector<word> inverses(N+1, 0), f, g, a, y(n);
+    for ( int j = 3; j <= N; j++ )
+        inverses[j] = inverse(reduce(long(j)*(j-2), p), p);
+
+    for ( int k = 0; k < n; k++ ) {
+        series(strong_field, N, word(k), p, inverses, f, g);
+        y[k] = hankdet(D, f.data() + d+1, p, a);
+    }
+
+    return interpolate(y, p);
+}
+
+//------------------------------------------------------------------------------
+// Reconstruct the rational coefficients of H from their residues modulo m,
+// in x. The coefficients are reconstructed one after the other multiplied
+// by the common denominator of the previous ones, so that only the new
+// factors of the denominator need to be found. Returns false if some
+// coefficient has no reconstruction yet. start is where to begin, and is
+// set to the coefficient that failed, which is likely to fail again.
+inline bool reconstruct(
+        const std::vector<ricpad::modular::int_t>& x,
+        const ricpad::modular::int_t& m, Polynomial& H, int& start
+        ) {
+    typedef ricpad::modular::int_t int_t;
+
+    const int n = x.size();
+    std::vector<int_t> num(n), den(n);
+    int_t L = 1, y;
+
+    for ( int i = 0; i < n; i++ ) {
+        const int k = (start + i) % n;
+
+        y = (L*x[k]) % m;
+        if ( ! ricpad::modular::rational(y, m, num[k], den[k]) ) {
+            start = k;
+            return false;
+        }
+
+        den[k] *= L;
+        L = lcm(L, den[k]);
+    }
+
+    H.num.assign(n, int_t(0));
+    H.den = L;
+    for ( int k = 0; k < n; k++ ) H.num[k] = num[k]*(L/den[k]);
+
+    // Drop the vanishing terms above the actual degree and common factors
+    while ( ! H.num.empty() && H.num.back() == 0 ) H.num.pop_back();
+    int_t c = H.den;
+    for ( const auto& a : H.num ) c = gcd(c, a);
+    if ( c > 1 ) {
+        for ( auto& a : H.num ) a /= c;
+        H.den /= c;
+    }
+
+    return true;
+}
+
+// Whether H agrees with the residues r of its coefficients modulo p
+inline bool agrees(const Polynomial& H, const std::vector<word>& r, word p) {
+    using namespace ricpad::modular;
+
+    const word den = reduce(H.den, p);
+    for ( int k = 0; k < int(r.size()); k++ ) {
+        const word num = k < int(H.num.size()) ? reduce(H.num[k], p) : 0;
+        if ( num != mul(den, r[k], p) ) return false;
+    }
+
+    return true;
+}
+
+// H[D,d] as an exact polynomial in x. The primes are the largest ones below
+// 2^31, and are processed in groups, one per thread of pool if it is not
+// null. The coefficients are reconstructed when the number of primes has
+// grown by a quarter since the last attempt, and once that succeeds, the
+// result is accepted if it agrees with the next group of primes. primes is
+// set to the number of primes used.
+inline Polynomial hankel_polynomial(
+        const bool strong_field, const int D, const int d,
+        ricpad::ThreadPool* pool = nullptr, int* primes = nullptr
+        ) {
+    using namespace ricpad::modular;
+
+    const int n = hankel_degree(D, d) + 1;
+    const int group = pool ? pool->size() : 1;
+
+    std::vector<int_t> x(n, int_t(0));
+    int_t m = 1;
+    Polynomial H;
+    bool candidate = false;
+    int used = 0, next_attempt = 1, start = 0;
+    word p = word(1) << 31;
+
+    while ( true ) {
+        std::vector<word> ps;
+        std::vector<std::vector<word>> residues(group);
+
+        for ( int i = 0; i < group; i++ ) ps.push_back(p = prime_before(p));
+
+        if ( pool ) {
+            std::vector<std::future<void>> tasks;
+            for ( int i = 0; i < group; i++ ) {
+                tasks.push_back(pool->submit([&, i] {
+                    residues[i] = hankel_residues(strong_field, D, d, ps[i]);
+                }));
+            }
+            for ( auto& t : tasks ) t.get();
+        } else {
+            residues[0] = hankel_residues(strong_field, D, d, ps[0]);
+        }
+
+        if ( candidate ) {
+            bool ok = true;
+            for ( int i = 0; ok && i < group; i++ )
+                ok = agrees(H, residues[i], ps[i]);
+
+            if ( ok ) break;
+        }
+
+        for ( int i = 0; i < group; i++ ) {
+            const word minv = inverse(reduce(m, ps[i]), ps[i]);
+            for ( int k = 0; k < n; k++ )
+                crt(x[k], m, residues[i][k], ps[i], minv);
+            m *= ps[i];
+        }
+        used += group;
+
+        candidate = false;
+        if ( used >= next_attempt ) {
+            candidate = reconstruct(x, m, H, start);
+            next_attempt = used + std::max(1, used/4);
+        }
+    }
+
+    if ( primes ) *primes = used + group;
+
+    return H;
+}
+
+//------------------------------------------------------------------------------
+// All the roots of an exact polynomial, and how far they can be trusted
+struct Roots {
+    typedef ricpad::aberth::Complex<mpfr_float> complex_t;
+
+    std::vector<complex_t> z;
+    // Sweeps of the last Aberth-Ehrlich iteration, and its precision
+    int iterations = 0, ndigits = 0;
+    // Whether the last iteration converged, whether its roots agree with
+    // those of the previous one, and whether the complex ones come in 
+    // conjugate pairs
+    bool converged = false, stable = false, conjugate = false;
+
+    bool reliable() const {return converged && stable && conjugate;};
+};
+
+// Number of decimal digits by which the largest coefficient of H exceeds
+// the leading one
+inline int coefficient_digits(const Polynomial& H) {
+    int top = 0, lead = 0;
+    for ( const auto& a : H.num ) {
+        if ( a == 0 ) continue;
+        lead = mp::msb(abs(a));
+        top = std::max(top, lead);
+    }
+    return int(0.30103*(top - lead)) + 1;
+}
+
+// Whether every root in z has a root in w within tol relative to its size
+inline bool agree(
+        const std::vector<Roots::complex_t>& z,
+        const std::vector<Roots::complex_t>& w, const mpfr_float& tol
+        ) {
+    if ( z.size() != w.size() ) return false;
+
+    for ( const auto& u : z ) {
+        const mpfr_float bound = tol*mp::max(mpfr_float(1), abs(u));
+        bool found = false;
+        for ( const auto& v : w ) 
+            if ( abs(u - v) <= bound ) {found = true; break;}
+        if ( ! found ) return false;
+    }
+    return true;
+}
+
+// The roots of H to ndigits digits. The polynomial is ill-conditioned when
+// its coefficients are large compared with the leading one, or it has close
+// roots, and an iteration at ndigits digits can then give a pair of close
+// real roots as two complex ones, or converge to wrong values. The first
+// iteration therefore works with coefficient_digits(H) more digits, and the
+// precision is doubled, up to maxdoublings times, until the roots of two
+// iterations agree to ndigits and the complex ones are conjugate pairs.
+// Restores the default precision of mpfr_float.
+inline Roots roots(
+        const Polynomial& H, const int ndigits, const int maxdoublings = 4
+        ) {
+    typedef Roots::complex_t complex_t;
+
+    const int digits0 = mpfr_float::default_precision();
+    const mpfr_float tol = pow(mpfr_float(10), 5 - ndigits);
+    const int degree = int(H.num.size()) - 1;
+
+    Roots r, last;
+    r.ndigits = ndigits + coefficient_digits(H) + 10;
+
+    for ( int n = 0; n <= maxdoublings; n++ ) {
+        mpfr_float::default_precision(r.ndigits);
+
+        // The roots do not change if H is multiplied by its denominator
+        std::vector<mpfr_float> a;
+        for ( const auto& c : H.num ) a.push_back(mpfr_float(c));
+
+        // Sweeps grow with the degree while the approximations spread from
+        // their starting circle
+        r.z = ricpad::aberth::roots<mpfr_float>(
+                a, mpfr_float(pow(mpfr_float(10), 5 - r.ndigits)),
+                std::max(100, 2*degree), &r.iterations, &r.converged);
+
+        // Complex roots whose conjugate is not among the roots
+        r.conjugate = true;
+        for ( const complex_t& u : r.z ) {
+            const mpfr_float bound = tol*mp::max(mpfr_float(1), abs(u));
+            if ( abs(u.im) <= bound ) continue;
+
+            bool found = false;
+            for ( const complex_t& v : r.z )
+                if ( abs(u - complex_t{v.re, -v.im}) <= bound ) {
+                    found = true;
+                    break;
+                }
+            r.conjugate = r.conjugate && found;
+        }
+
+        r.stable = n > 0 && last.converged && agree(r.z, last.z, tol);
+        if ( r.reliable() ) break;
+
+        last = r;
+        if ( n < maxdoublings ) r.ndigits *= 2;
+    }
+
+    mpfr_float::default_precision(digits0);
+
+    return r;
+}
+
+} // namespace
+#endif
@@ -0,0 +1,381 @@
+#ifndef TF_POLYNOMIALS_HPP
+#define TF_POLYNOMIALS_HPP
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <utility>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <boost/multiprecision/gmp.hpp>
+#include <boost/multiprecision/mpfr.hpp>
+
+#include <ricpad/precision.hpp>
+
+namespace mp = boost::multiprecision;
+using mp::mpfr_float;
+
+// Taylor coefficients of the Thomas-Fermi series as exact polynomials in f2,
+//
+//     f[j] = (num[0] + num[1]*f2 + num[2]*f2^2 + ...) / den,
+//
+// with integer num and den. They are obtained once from the same recurrences
+// as coefs and coefs_strong, and can be stored in a binary file so that later
+// runs skip that step. Each trial series then costs a dot product per
+// coefficient, with the powers of f2 shared by all of them, instead of a run
+// of the recurrence.
+class SeriesPolynomials {
+    public:
+        typedef mp::mpz_int int_t;
+
+        struct Polynomial {
+            std::vector<int_t> num;
+            int_t den = 1;
+        };
+
+    private:
+        typedef std::vector<std::vector<mpfr_float>> Table;
+
+        bool strong_field_;
+        // Coefficients f[0], f[1], ...
+        std::vector<Polynomial> fj_;
+        // g[k] = sum_l f[l]*f[k-l], only used by the isolated atom recurrence
+        std::vector<Polynomial> gj_;
+
+        // The coefficients of fj_ as floating point numbers for the last
+        // precisions used, most recent first. The sweeps raise the 
+        // precision at almost every D, so only a few are kept; two cover
+        // the alternation between a cheap and a full precision.
+        std::vector<std::pair<unsigned, std::shared_ptr<const Table>>> 
+            tables_;
+        static const int max_tables_ = 2;
+        std::mutex mutex_;
+
+        static Polynomial constant(int c) {
+            Polynomial p;
+            if ( c != 0 ) p.num.push_back(c);
+            return p;
+        };
+
+        static Polynomial product(const Polynomial& a, const Polynomial& b) {
+            Polynomial p;
+            if ( a.num.empty() || b.num.empty() ) return p;
+
+            p.num.assign(a.num.size() + b.num.size() - 1, int_t(0));
+            for ( int i = 0; i < int(a.num.size()); i++ )
+                for ( int k = 0; k < int(b.num.size()); k++ )
+                    p.num[i+k] += a.num[i]*b.num[k];
+            p.den = a.den*b.den;
+
+            return p;
+        };
+
+        // acc += c*p
+        static void add(Polynomial& acc, const Polynomial& p, long c) {
+            if ( p.num.empty() || c == 0 ) return;
+
+            int_t den = lcm(acc.den, p.den);
+            int_t sa = den/acc.den, sp = c*(den/p.den);
+
+            if ( acc.num.size() < p.num.size() )
+                acc.num.resize(p.num.size(), int_t(0));
+            if ( sa != 1 )
+                for ( auto& a : acc.num ) a *= sa;
+            for ( int k = 0; k < int(p.num.size()); k++ )
+                acc.num[k] += sp*p.num[k];
+            acc.den = std::move(den);
+        };
+
+        // Divide num and den by their common factors and drop the vanishing
+        // leading terms
+        static void normalize(Polynomial& p) {
+            while ( ! p.num.empty() && p.num.back() == 0 ) p.num.pop_back();
+            if ( p.num.empty() ) {
+                p.den = 1;
+                return;
+            }
+
+            int_t g = p.den;
+            for ( const auto& a : p.num ) {
+                if ( g == 1 ) break;
+                g = gcd(g, a);
+            }
+            if ( p.den < 0 ) g = -g;
+
+            if ( g != 1 ) {
+                for ( auto& a : p.num ) a /= g;
+                p.den /= g;
+            }
+        };
+
+        // Append g[k] for k = gj_.size()
+        void push_convolution() {
+            int k = gj_.size();
+            Polynomial g;
+
+            for ( int l = 0; 2*l <= k; l++ )
+                add(g, product(fj_[l], fj_[k-l]), 2*l == k ? 1 : 2);
+            normalize(g);
+
+            gj_.push_back(std::move(g));
+        };
+
+        static void write(std::ostream& out, const int_t& x) {
+            std::size_t count = 0;
+            std::int8_t sign = x.sign();
+            void* bytes = mpz_export(
+                    nullptr, &count, 1, 1, 1, 0, x.backend().data());
+
+            std::uint64_t size = count;
+            out.write((const char*)&sign, sizeof(sign));
+            out.write((const char*)&size, sizeof(size));
+            out.write((const char*)bytes, count);
+
+            void (*free_function)(void*, std::size_t);
+            mp_get_memory_functions(nullptr, nullptr, &free_function);
+            free_function(bytes, count);
+        };
+
+        static bool read(std::istream& in, int_t& x) {
+            std::int8_t sign;
+            std::uint64_t size;
+            if ( ! in.read((char*)&sign, sizeof(sign)) ) return false;
+            if ( ! in.read((char*)&size, sizeof(size)) ) return false;
+
+            std::vector<char> bytes(size);
+            if ( ! in.read(bytes.data(), size) ) return false;
+
+            mpz_import(x.backend().data(), size, 1, 1, 1, 0, bytes.data());
+            if ( sign < 0 ) x = -x;
+
+            return true;
+        };
+
+    public:
+        SeriesPolynomials(bool strong_field) : strong_field_(strong_field) {
+            fj_.push_back(constant(1));
+            fj_.push_back(constant(0));
+            fj_.push_back(Polynomial());
+            fj_.back().num = {int_t(0), int_t(1)};
+
+            if ( strong_field_ ) {
+                fj_.push_back(constant(0));
+            } else {
+                for ( int k = 0; k < 3; k++ ) push_convolution();
+            }
+        };
+
+        //----------------------------------------------------------------------
+        // Compute the polynomials up to f[N]. Already computed polynomials
+        // are reused. Returns true if new polynomials were computed.
+        bool extend(int N) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const bool extended = N >= int(fj_.size());
+
+            for ( int j = fj_.size(); j <= N; j++ ) {
+                Polynomial A;
+
+                // The products f[a]*f[j-a] of both recurrences, grouping
+                // each pair with its mirror image
+                for ( int a = 0; 2*a <= j; a++ ) {
+                    int b = j - a;
+                    long c = 0;
+
+                    if ( a >= 2 && a <= j-1 ) c += a*(a-1);
+                    if ( a >= 1 && a <= j-2 ) c += a*(b-1);
+                    if ( a != b ) {
+                        if ( b >= 2 && b <= j-1 ) c += b*(b-1);
+                        if ( b >= 1 && b <= j-2 ) c += b*(a-1);
+                    }
+
+                    if ( c != 0 ) add(A, product(fj_[a], fj_[b]), c);
+                }
+
+                if ( strong_field_ ) {
+                    if ( j > 4 ) add(A, fj_[j-5], -2);
+                } else {
+                    for ( int k = 0; k < j-2; k++ )
+                        add(A, product(gj_[k], fj_[j-k-3]), -2);
+                }
+
+                A.den *= -j*(j-2);
+                normalize(A);
+                fj_.push_back(std::move(A));
+
+                if ( ! strong_field_ ) push_convolution();
+            }
+
+            return extended;
+        };
+
+        //----------------------------------------------------------------------
+        // Store the polynomials in path. Returns false if the file could not
+        // be written.
+        bool save(const std::string& path) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::ofstream out(path, std::ios::binary);
+
+            const char magic[8] = {'t','f','p','o','l','y','0','1'};
+            std::int8_t strong = strong_field_;
+            std::uint64_t nf = fj_.size(), ng = gj_.size();
+
+            out.write(magic, sizeof(magic));
+            out.write((const char*)&strong, sizeof(strong));
+            out.write((const char*)&nf, sizeof(nf));
+            out.write((const char*)&ng, sizeof(ng));
+
+            for ( const auto* v : {&fj_, &gj_} ) {
+                for ( const auto& p : *v ) {
+                    std::uint64_t n = p.num.size();
+                    out.write((const char*)&n, sizeof(n));
+                    write(out, p.den);
+                    for ( const auto& a : p.num ) write(out, a);
+                }
+            }
+
+            return bool(out);
+        };
+
+        //----------------------------------------------------------------------
+        // Replace the polynomials with those stored in path, if it exists and
+        // holds more of them for the same equation. Returns false otherwise.
+        bool load(const std::string& path) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::ifstream in(path, std::ios::binary);
+
+            char magic[8];
+            std::int8_t strong;
+            std::uint64_t nf, ng;
+
+            if ( ! in.read(magic, sizeof(magic)) ) return false;
+            if ( std::string(magic, 8) != "tfpoly01" ) return false;
+            if ( ! in.read((char*)&strong, sizeof(strong)) ) return false;
+            if ( bool(strong) != strong_field_ ) return false;
+            if ( ! in.read((char*)&nf, sizeof(nf)) ) return false;
+            if ( ! in.read((char*)&ng, sizeof(ng)) ) return false;
+            if ( nf <= fj_.size() ) return false;
+
+            std::vector<Polynomial> fj(nf), gj(ng);
+
+            for ( auto* v : {&fj, &gj} ) {
+                for ( auto& p : *v ) {
+                    std::uint64_t n;
+                    if ( ! in.read((char*)&n, sizeof(n)) ) return false;
+                    if ( ! read(in, p.den) ) return false;
+
+                    p.num.resize(n);
+                    for ( auto& a : p.num )
+                        if ( ! read(in, a) ) return false;
+                }
+            }
+
+            fj_ = std::move(fj);
+            gj_ = std::move(gj);
+            tables_.clear();
+
+            return true;
+        };
+
+        //----------------------------------------------------------------------
+        // Storage reused by successive calls to coefs, which then do not
+        // allocate as long as N and the precision do not grow
+        template <typename num_t>
+        struct Workspace {
+            std::vector<num_t> fj, powers;
+            num_t t;
+        };
+
+        // Coefficients f[0]...f[N] for the given f2, evaluated with the
+        // precision of the calling thread and stored in the first N+1 
+        // elements of ws.fj. Polynomials up to f[N] must have been computed
+        // with extend.
+        template <typename num_t>
+        const std::vector<num_t>& coefs(
+                int N, const num_t& f2, Workspace<num_t>& ws
+                ) {
+            const unsigned digits = ricpad::precision<num_t>::get();
+            std::shared_ptr<const Table> table;
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+
+                // The table for digits, moved to the front, or a new one
+                // in place of the oldest
+                auto it = std::find_if(tables_.begin(), tables_.end(), 
+                        [digits] (const std::pair<unsigned, 
+                            std::shared_ptr<const Table>>& e) -> bool {
+                            return e.first == digits;
+                        });
+                if ( it == tables_.end() ) {
+                    if ( int(tables_.size()) >= max_tables_ ) 
+                        tables_.pop_back();
+                    tables_.emplace(tables_.begin(), digits, nullptr);
+                } else {
+                    std::rotate(tables_.begin(), it, it+1);
+                }
+                auto& t = tables_.front().second;
+
+                // Convert the polynomials to floating point
+                if ( ! t || int(t->size()) <= N ) {
+                    std::shared_ptr<Table> conv(new Table(fj_.size()));
+
+                    for ( int j = 0; j < int(fj_.size()); j++ ) {
+                        mpfr_float den(fj_[j].den, digits);
+                        for ( const auto& a : fj_[j].num )
+                            (*conv)[j].push_back(mpfr_float(a, digits)/den);
+                    }
+
+                    t = conv;
+                }
+
+                table = t;
+            }
+
+            std::vector<num_t> &fj = ws.fj, &powers = ws.powers;
+            if ( int(fj.size()) <= N ) fj.resize(N+1);
+            if ( powers.empty() ) powers.resize(1);
+
+            // Number of valid powers of f2
+            int np = 1;
+            powers[0] = 1;
+
+            for ( int j = 0; j <= N; j++ ) {
+                const auto& c = (*table)[j];
+
+                for ( ; np < int(c.size()); np++ ) {
+                    if ( np == int(powers.size()) ) powers.emplace_back();
+                    powers[np] = powers[np-1];
+                    powers[np] *= f2;
+                }
+
+                num_t& f = fj[j];
+                f = 0;
+                for ( int k = 0; k < int(c.size()); k++ ) {
+                    ws.t = powers[k];
+                    ws.t *= c[k];
+                    f += ws.t;
+                }
+            }
+
+            return fj;
+        };
+
+        // Same as above, returning a new vector
+        template <typename num_t>
+        std::vector<num_t> coefs(int N, const num_t& f2) {
+            Workspace<num_t> ws;
+            coefs(N, f2, ws);
+
+            return ws.fj;
+        };
+
+        //----------------------------------------------------------------------
+        // Getters
+        int size() const {return fj_.size();};
+        bool strong_field() const {return strong_field_;};
+        const Polynomial& operator[](int j) const {return fj_[j];};
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef TF_PROFILE_HPP
+#define TF_PROFILE_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include <vector>
+#include <boost/multiprecision/mpfr.hpp>
+
+#include <ricpad/pade.hpp>
+#include <tf.hpp>
+
+namespace mp = boost::multiprecision;
+using mp::mpfr_float;
+
+namespace profile {
+
+//------------------------------------------------------------------------------
+// Approximation to the solution phi(x) of the equation with slope phi'(0) at
+// the origin. The Taylor series solved by the Hankel-Pade method is that of
+// f(t) = sqrt(phi(t^2)), whose second coefficient is slope/2, so that
+//
+//     phi(x) ~= (P(sqrt(x))/Q(sqrt(x)))^2,
+//
+// with P/Q its [D/D] Pade approximant. The approximant is built with the
+// precision of mpfr_float and evaluated with R, either double or long double.
+template <class R>
+class Profile {
+    private:
+        ricpad::pade::Rational<R> f_;
+        int D_;
+
+        // Number of points evaluated together by evaluate
+        static const int block_ = 4096;
+
+    public:
+        Profile(const bool strong_field, const int D, const mpfr_float& slope)
+            : D_(D) {
+            Series<mpfr_float> series(mpfr_float(slope/2), strong_field);
+            series.extend(2*D);
+
+            std::vector<mpfr_float> p, q;
+            ricpad::pade::pade<mpfr_float>(D, D, series.data(), p, q);
+            f_ = ricpad::pade::Rational<R>(p, q);
+        };
+
+        //----------------------------------------------------------------------
+        int D() const {return D_;};
+
+        // phi at the points x[0]...x[n-1], which should not be negative,
+        // stored in phi, which may be x
+        void evaluate(const R* x, R* phi, const std::size_t n) const {
+            R t[block_];
+
+            for ( std::size_t start = 0; start < n; start += block_ ) {
+                const int b = int(std::min<std::size_t>(block_, n - start));
+
+                for ( int i = 0; i < b; i++ ) t[i] = std::sqrt(x[start+i]);
+                f_.evaluate(t, t, b);
+                for ( int i = 0; i < b; i++ ) phi[start+i] = t[i]*t[i];
+            }
+        };
+
+        // phi at a single point
+        R operator()(const R x) const {
+            R y;
+            evaluate(&x, &y, 1);
+            return y;
+        };
+};
+
+} // namespace
+#endif
@@ -0,0 +1,134 @@
+#ifndef TF_STATS_HPP
+#define TF_STATS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <sys/resource.h>
+
+namespace stats {
+
+//------------------------------------------------------------------------------
+// Time spent in each phase of the evaluations of H[D,d], added up over all
+// the threads that take part in them
+struct Phases {
+    std::atomic<long long> series{0}, hankdet{0};
+};
+
+// Measures the time from its construction to its destruction, and adds it
+// to a counter of nanoseconds. Does nothing if the counter is null.
+class Timer {
+    private:
+        std::atomic<long long>* total_;
+        std::chrono::steady_clock::time_point start_;
+
+    public:
+        Timer(std::atomic<long long>* total) : total_(total) {
+            if ( total_ ) start_ = std::chrono::steady_clock::now();
+        };
+
+        ~Timer() {
+            if ( ! total_ ) return;
+            *total_ += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start_).count();
+        };
+};
+
+// Seconds elapsed since start
+inline double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+}
+
+// Peak resident memory of the process, in kilobytes
+inline long peak_rss_kb() {
+    struct rusage usage;
+    if ( getrusage(RUSAGE_SELF, &usage) != 0 ) return -1;
+
+    return usage.ru_maxrss;
+}
+
+//------------------------------------------------------------------------------
+// What solving H[D,d] = 0 for one D cost
+struct Record {
+    std::string mode;
+    int d = 0, D = 0, ndigits = 0;
+    int iterations = 0, evaluations = 0;
+    // Wall time of the solve, and the time spent in the series and in the
+    // Hankel determinants, in seconds. The remaining time of the solve is
+    // taken by the solver itself; it can come out negative when the 
+    // evaluations of each iteration run in several threads.
+    double total = 0, series = 0, hankdet = 0;
+    // Whether the root was taken from the result cache
+    bool cached = false;
+    // Whether the solver failed for D, in which case there is no root and
+    // total is the time of the failed solve
+    bool failed = false;
+    std::string x, dE;
+};
+
+// Writes a Record for each D to a file, as JSON lines or as CSV with a
+// header line. With append, the records are added to those already in the
+// file, e.g. when a sweep is resumed, and the header is only written if the
+// file is empty.
+class Writer {
+    private:
+        std::ofstream out_;
+        bool csv_;
+
+    public:
+        Writer(
+                const std::string& path, const std::string& format,
+                bool append = false
+                ) :
+            csv_(format == "csv") {
+            bool empty = true;
+            if ( append ) {
+                std::ifstream in(path);
+                empty = ! in || in.peek() == std::ifstream::traits_type::eof();
+            }
+
+            out_.open(path, append ? std::ios::app : std::ios::trunc);
+            if ( csv_ && empty )
+                out_ << "mode,d,D,ndigits,iterations,evaluations,cached,failed,"
+                    "time_total,time_series,time_hankdet,time_solver,"
+                    "peak_rss_kb,x,dE" << std::endl;
+        };
+
+        bool good() const {return bool(out_);};
+
+        //----------------------------------------------------------------------
+        // Write r, along with the current peak memory of the process
+        void write(const Record& r) {
+            const double solver = r.total - r.series - r.hankdet;
+
+            if ( csv_ ) {
+                out_
+                    << r.mode << ',' << r.d << ',' << r.D << ',' << r.ndigits
+                    << ',' << r.iterations << ',' << r.evaluations
+                    << ',' << r.cached << ',' << r.failed
+                    << ',' << r.total << ',' << r.series << ',' << r.hankdet
+                    << ',' << solver << ',' << peak_rss_kb()
+                    << ',' << r.x << ',' << r.dE << std::endl;
+            } else {
+                out_
+                    << "{\"mode\": \"" << r.mode << "\", \"d\": " << r.d
+                    << ", \"D\": " << r.D << ", \"ndigits\": " << r.ndigits
+                    << ", \"iterations\": " << r.iterations
+                    << ", \"evaluations\": " << r.evaluations
+                    << ", \"cached\": " << (r.cached ? "true" : "false")
+                    << ", \"failed\": " << (r.failed ? "true" : "false")
+                    << ", \"time_total\": " << r.total
+                    << ", \"time_series\": " << r.series
+                    << ", \"time_hankdet\": " << r.hankdet
+                    << ", \"time_solver\": " << solver
+                    << ", \"peak_rss_kb\": " << peak_rss_kb()
+                    << ", \"x\": \"" << r.x << "\", \"dE\": \"" << r.dE
+                    << "\"}" << std::endl;
+            }
+        };
+};
+
+} // namespace
+#endif
@@ -1,13 +1,30 @@
 #include <vector>
 #include <functional>
 #include <algorithm>
+#include <memory>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
 
 #include <boost/multiprecision/mpfr.hpp>
 #include <boost/program_options.hpp>
 
+#include <ricpad/aberth.hpp>
+#include <ricpad/chebyshev.hpp>
 #include <ricpad/hankdet.hpp>
+#include <ricpad/precision.hpp>
+#include <ricpad/thread_pool.hpp>
+#include <solver/dual.hpp>
 #include <solver/solver.hpp>
 #include <tf.hpp>
+#include <tf_checkpoint.hpp>
+#include <tf_engine.hpp>
+#include <tf_exact.hpp>
+#include <tf_polynomials.hpp>
+#include <tf_profile.hpp>
+#include <tf_stats.hpp>
 
 namespace mp = boost::multiprecision;
 using mp::mpfr_float;
@@ -34,6 +51,92 @@ void print_help_message(std::string const &a = "") {
     std::cout << optional << std::endl;
 }
 
+using engine::HankelMethod;
+
+// Print the root found for one of the cross-d values, preceded by prefix, 
+// along with its distance to the root x of d if it is not null
+void print_cross(
+        const std::string &prefix, const engine::CrossRoot &c, 
+        const mpfr_float* x
+        ) {
+    std::cout << prefix << "    d = " << c.d;
+
+    if ( c.converged ) {
+        std::cout 
+            << " " << std::setprecision(c.root.x.precision()) << c.root.x;
+        if ( x ) 
+            std::cout << " diff: " << std::setprecision(4) << abs(c.root.x - *x);
+        std::cout 
+            << " iters: " << c.root.iterations
+            << " evals: " << c.root.evaluations;
+    } else {
+        std::cout << " failed";
+    }
+
+    std::cout << std::endl;
+}
+
+// Print the enclosure e of a root certified to digits digits, preceded by
+// prefix
+void print_enclosure(
+        const std::string &prefix, const engine::Enclosure &e,
+        const int digits
+        ) {
+    std::cout << prefix << "    ";
+    if ( e.certified ) {
+        std::cout
+            << "enclosure: " << e.x.str(digits + 2)
+            << " certified digits: " << std::setprecision(3) << e.digits;
+    } else {
+        std::cout << "not certified";
+    }
+    std::cout
+        << " iters: " << e.iterations << " digits: " << e.ndigits << std::endl;
+}
+
+// Read points x from in, one per line, and write "x phi(x)" lines to out. The
+// points are evaluated in chunks, so that the grid may be larger than the
+// memory. Returns false if a line is not a number.
+template <class R>
+bool write_profile(
+        const profile::Profile<R> &phi, std::istream &in, FILE* out
+        ) {
+    const std::size_t chunk = 1 << 16;
+    const int digits = std::numeric_limits<R>::max_digits10;
+
+    std::vector<R> x(chunk), y(chunk);
+    std::string line;
+    char buffer[128];
+
+    while ( in ) {
+        std::size_t n = 0;
+
+        while ( n < chunk && std::getline(in, line) ) {
+            if ( line.find_first_not_of(" \t\r") == std::string::npos ) 
+                continue;
+
+            char* end;
+            x[n] = R(std::strtold(line.c_str(), &end));
+            if ( end == line.c_str() ) {
+                std::cout << "Not a number: " << line << "." << std::endl;
+                return false;
+            }
+            n++;
+        }
+
+        phi.evaluate(x.data(), y.data(), n);
+
+        for ( std::size_t i = 0; i < n; i++ ) {
+            const int size = std::snprintf(
+                    buffer, sizeof(buffer), "%.*Lg %.*Lg\n", 
+                    digits, (long double)(x[i]), digits, (long double)(y[i]));
+            std::fwrite(buffer, 1, size, out);
+        }
+    }
+
+    return true;
+}
+
 int main(int argc, char* argv[]) {
     optional.add_options()
         ("help", po::value<std::string>()
@@ -51,6 +154,14 @@ int main(int argc, char* argv[]) {
         ("d", po::value<int>()->default_value(-1), "Value of d."
          "Set automatically to 3 for the isolated atom equation and to 4 for "
          "the strong field one.")
+        ("cross-d", po::value<std::vector<int>>()->multitoken()
+         ->default_value({}, ""),
+         "Other values of d for which H[D,d] = 0 is solved at each D along "
+         "with d, starting from the same point, to cross-check its roots. "
+         "Their roots are printed after that of d with their distance to "
+         "it. The series at the common starting point is computed once, up "
+         "to the largest d, and reused by all the values of d; the other "
+         "points of each solve are its own.")
         /*("no-auto-precision", po::bool_switch(),
          "This program automatically sets the number of digits used in its "
          "computations, the Newton-Raphson step size and its tolerance. "
@@ -66,7 +177,190 @@ int main(int argc, char* argv[]) {
         ("ndigits", po::value<int>()->default_value(40),
          "Number of digits for the numerical calculations. "
          "The program increases this number automatically when ndigits is less"
-         " than -2*log10(h).")
+         " than -2*log10(h) and the derivative is numeric.")
+        ("derivative", po::value<std::string>()->default_value("numeric"),
+         "How the Newton-Raphson method obtains the derivative of the Hankel "
+         "determinant. 'numeric' uses a central difference with step h, "
+         "which needs three evaluations per iteration. 'exact' uses "
+         "automatic differentiation, which needs a single evaluation per "
+         "iteration and does not tie ndigits to h.")
+        ("hankdet", po::value<std::string>()->default_value("dodgson"),
+         "Method for the Hankel determinants. 'dodgson' uses Dodgson "
+         "condensation, with O(D^3) operations. 'chebyshev' uses the "
+         "Chebyshev algorithm, with O(D^2) operations, and falls back to "
+         "Gaussian elimination with pivoting when a leading minor vanishes.")
+        ("hankdet-threads", po::value<int>()->default_value(1),
+         "Number of threads that share the work of each level of the Dodgson "
+         "condensation.")
+        ("hankdet-serial-D", po::value<int>()->default_value(32),
+         "Determinants with D below this value are computed by a single "
+         "thread even if hankdet-threads is larger than 1.")
+        ("nr-threads", po::value<int>()->default_value(1),
+         "Number of threads evaluating the Hankel determinants at x+h, x-h "
+         "and x in each Newton-Raphson iteration. Only relevant when the "
+         "derivative is numeric; 3 evaluates them all at the same time.")
+        ("method", po::value<std::string>()->default_value("newton"),
+         "Iteration used to solve H[D,d] = 0: newton, secant, steffensen, "
+         "illinois, brent or halley. Per iteration, newton and halley "
+         "evaluate H[D,d] three times (one and two times with the exact "
+         "derivative), steffensen twice, and the rest once. secant starts "
+         "from the roots of the two previous D values, and illinois and "
+         "brent from the interval between them. The iterations and "
+         "evaluations needed for each D are printed with its root.")
+        ("accel", po::value<std::string>()->default_value("none"),
+         "Sequence acceleration applied to the roots found so far to "
+         "estimate their limit as D grows: none, aitken, richardson (in "
+         "powers of 1/D), wynn (epsilon algorithm) or levin (u transform). "
+         "The estimate is printed after each root and is the starting point "
+         "for the next D.")
+        ("accel-terms", po::value<int>()->default_value(6),
+         "Number of the latest roots used by the sequence acceleration.")
+        ("nr-start-digits", po::value<int>()->default_value(0),
+         "If larger than 0, each Newton-Raphson solve starts working with "
+         "this number of digits, doubling it until the digits lost to "
+         "cancellation are known, and then raises it as the iterate "
+         "converges, so that only the last iterations use ndigits digits. "
+         "Pays off when ndigits is much larger than needed by the first "
+         "iterations.")
+        ("series", po::value<std::string>()->default_value("recurrence"),
+         "How the Taylor coefficients are obtained for each value of x. "
+         "'recurrence' runs the recurrence of the equation every time. "
+         "'polynomial' computes the coefficients once as exact polynomials "
+         "in x, and evaluates them afterwards.")
+        ("backend", po::value<std::string>()->default_value("dynamic"),
+         "Numbers used by the solver. 'dynamic' works with ndigits digits "
+         "and allocates the limbs of every number on the heap. 'fixed' "
+         "works with the smallest of 30 (double-double), 60 (quad-double), "
+         "100, 250, 500 and 1000 digits that is not below ndigits, with "
+         "numbers that do not allocate, and falls back to dynamic above "
+         "1000 digits. Double-double and quad-double give way to 50 digits, "
+         "or the next size above ndigits, when H[D,d] leaves the exponent "
+         "range of double. Not "
+         "available with the polynomial series or nr-start-digits.")
+        ("series-cache", po::value<std::string>()->default_value(""),
+         "File where the polynomials of the 'polynomial' series are stored, "
+         "so that other runs for the same mode do not need to compute them "
+         "again.")
+        ("eval", po::bool_switch()->default_value(false),
+         "Instead of solving, print H[D,d] evaluated at x0 for every D "
+         "between Dmin and Dmax. All of them are obtained from a single "
+         "series and a single determinant computation.")
+        ("exact", po::bool_switch()->default_value(false),
+         "Instead of solving, compute H[D,d] as an exact polynomial in x "
+         "for every D between Dmin and Dmax, and print its degree and all "
+         "its roots, nearest to x0 first, which shows the roots close to "
+         "the one followed by the solver. The polynomial is rebuilt from its "
+         "values modulo word-size primes, and its roots are found together "
+         "with the Aberth-Ehrlich iteration, with more digits than ndigits "
+         "as the size of the coefficients requires, doubled until the "
+         "roots agree to ndigits between two iterations and the complex "
+         "ones are conjugate pairs; the roots are marked 'not stable' or "
+         "'not conjugate' if that is not reached. Roots whose imaginary "
+         "part is below tol relative to them are printed as real.")
+        ("exact-threads", po::value<int>()->default_value(1),
+         "Number of primes processed at the same time by exact.")
+        ("exact-output", po::value<std::string>()->default_value(""),
+         "File where exact writes the coefficients of the polynomials, as "
+         "their numerators for each power of x and their common "
+         "denominator.")
+        ("scan", po::bool_switch()->default_value(false),
+         "Instead of solving from x0, look for all the roots of H[D,d] with "
+         "x between scan-min and scan-max for every D between Dmin and "
+         "Dmax. H[D,d] is evaluated at scan-points evenly spaced values of "
+         "x with scan-digits digits, and again with ndigits digits where "
+         "the rounding errors hide its sign. Every sign change is refined "
+         "with Brent's method, and every local minimum of |H[D,d]| without "
+         "one with the selected method, with ndigits digits and tolerance "
+         "tol, and then the other root of the pair with Brent's method. The "
+         "points whose sign remains unknown are counted as 'unknown "
+         "signs'; raising ndigits resolves them. The scan is not "
+         "exhaustive: a pair of roots closer than the spacing of the "
+         "points can be missed when it leaves no minimum among them, and "
+         "more points make that less likely.")
+        ("scan-min", po::value<std::string>()->default_value("-2"),
+         "Lower end of the interval of x for scan.")
+        ("scan-max", po::value<std::string>()->default_value("-0.5"),
+         "Upper end of the interval of x for scan.")
+        ("scan-points", po::value<int>()->default_value(200),
+         "Number of values of x at which scan evaluates H[D,d].")
+        ("scan-digits", po::value<int>()->default_value(30),
+         "Number of digits of the first evaluations of scan.")
+        ("scan-threads", po::value<int>()->default_value(1),
+         "Number of threads sharing the evaluations and refinements of "
+         "scan.")
+        ("certify", po::value<int>()->default_value(0),
+         "If larger than 0, prove that each root of the sweep is a simple "
+         "root of H[D,d] and enclose it in an interval this many digits "
+         "wide, relative to the root, with the interval Newton method. H "
+         "and its derivative are evaluated in interval arithmetic, starting "
+         "with the larger of ndigits and certify+20 digits and doubling "
+         "them when the rounding errors stop the enclosure from shrinking. "
+         "The endpoints are printed rounded outwards.")
+        ("sweep-threads", po::value<int>()->default_value(1),
+         "Number of D values solved concurrently. When larger than 1, each "
+         "D starts from a value extrapolated from the roots already found, "
+         "and is solved again from the previous root if the result is not "
+         "consistent with them. Results are still printed in order of D.")
+        ("precision-control", po::value<std::string>()->default_value("growth"),
+         "How ndigits is chosen for the next D. 'growth' makes it four times "
+         "the digits of the difference between the last two roots (and "
+         "twice those of h with the numeric derivative), and never lowers "
+         "it. 'error-bound' evaluates a running error bound through the "
+         "Dodgson condensation at each root to obtain the digits lost to "
+         "rounding, and uses the smallest ndigits that leaves ten more "
+         "digits than tol (or h with the numeric derivative) after that "
+         "loss, raising or lowering it as needed.")
+        ("checkpoint", po::value<std::string>()->default_value(""),
+         "File where the state of the sweep is written as it advances. If "
+         "it exists when the program starts, the sweep resumes after the "
+         "last D stored in it, with the same roots, precision, tolerance "
+         "and step size. Dmin and x0 are then ignored. A file that exists "
+         "but is not a valid checkpoint stops the program instead of being "
+         "overwritten.")
+        ("checkpoint-every", po::value<int>()->default_value(1),
+         "Number of D values between two writes of the checkpoint.")
+        ("result-cache", po::value<std::string>()->default_value(""),
+         "File where every root is stored along with the mode, d, D and "
+         "number of digits used to find it. Later runs take the roots for "
+         "the same mode, d, D and digits from it instead of solving again.")
+        ("stats", po::value<std::string>()->default_value(""),
+         "File where a record is written for each D, with the time spent "
+         "computing series, Hankel determinants and in the solver itself, "
+         "the number of iterations and evaluations, the number of digits "
+         "and the peak memory of the process.")
+        ("stats-format", po::value<std::string>()->default_value("json"),
+         "Format of the stats file: json, for one JSON object per line, or "
+         "csv.")
+        ("jobs", po::value<std::string>()->default_value(""),
+         "Instead of a single sweep, run the jobs described in this file, or "
+         "in the standard input if it is '-', one per line, as they are "
+         "read. Each line holds key=value pairs for any of mode, d, Dmin, "
+         "Dmax, Dstep, x0, tol, h, ndigits, derivative, method, nr-max-iter, "
+         "nr-start-digits, series, backend, precision-control, cross-d "
+         "(with the values separated by commas), accel, accel-terms, "
+         "sweep-threads, checkpoint, checkpoint-every and certify; the "
+         "other fields take the values given on the command line, except "
+         "Dmax, which defaults to Dmin, and checkpoint, which cannot be "
+         "given on the command line. Lines starting with # are skipped. "
+         "The results of each D are printed as soon as they are found, "
+         "preceded by the number of the job, and all the jobs share thread "
+         "pools, caches and the stats file. Cannot be combined with eval, "
+         "exact, scan or profile-grid.")
+        ("profile-grid", po::value<std::string>()->default_value(""),
+         "After the sweep, build the [D/D] Pade approximant of the solution "
+         "phi(x) from the root of the last D, and evaluate it at the points "
+         "x read from this file, or from the standard input if it is '-', "
+         "one per line. Each point is written with its value of phi on a "
+         "line of profile-output. Needs a finite Dmax. The solution of the "
+         "strong field equation vanishes at a finite x, beyond which the "
+         "values are meaningless.")
+        ("profile-output", po::value<std::string>()->default_value(""),
+         "File where the values of phi are written. If empty, they are "
+         "printed after the results of the sweep.")
+        ("profile-type", po::value<std::string>()->default_value("double"),
+         "Floating point type with which phi is evaluated: double or "
+         "long-double. The approximant is built with ndigits digits either "
+         "way.")
         ("log-nr", po::bool_switch()->default_value(false), 
          "Set this option to print out each Newton-Raphson iteration.")
         ("nr-max-iter", po::value<int>()->default_value(20), 
@@ -97,184 +391,591 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    // Dmin
-    int Dmin = vm["Dmin"].as<int>();
+    // The sweep described by the options. In jobs mode, it provides the 
+    // defaults of the jobs.
+    engine::Job job;
+    if ( vm.count("mode") ) job.mode = vm["mode"].as<std::string>();
+    job.Dmin = vm["Dmin"].as<int>();
+    job.Dmax = vm["Dmax"].as<int>();
+    job.Dstep = vm["Dstep"].as<int>();
+    job.d = vm["d"].as<int>();
+    job.cross_d = vm["cross-d"].as<std::vector<int>>();
+    job.x0 = vm["x0"].as<std::string>();
+    job.tol = vm["tol"].as<std::string>();
+    job.h = vm["h"].as<std::string>();
+    job.ndigits = vm["ndigits"].as<int>();
+    job.derivative = vm["derivative"].as<std::string>();
+    job.method = vm["method"].as<std::string>();
+    job.maxiter = vm["nr-max-iter"].as<int>();
+    job.nr_start_digits = vm["nr-start-digits"].as<int>();
+    job.series = vm["series"].as<std::string>();
+    job.backend = vm["backend"].as<std::string>();
+    job.precision_control = vm["precision-control"].as<std::string>();
+    job.accel = vm["accel"].as<std::string>();
+    job.accel_terms = vm["accel-terms"].as<int>();
+    job.sweep_threads = vm["sweep-threads"].as<int>();
+    job.checkpoint = vm["checkpoint"].as<std::string>();
+    job.checkpoint_every = vm["checkpoint-every"].as<int>();
+    job.certify = vm["certify"].as<int>();
+
+    // Method for the Hankel determinants
+    HankelMethod hankdet_method;
+    hankdet_method.name = vm["hankdet"].as<std::string>();
+    hankdet_method.Dserial = vm["hankdet-serial-D"].as<int>();
+    int hankdet_threads = vm["hankdet-threads"].as<int>();
+
+    // Where the polynomials of the series are stored
+    std::string series_cache = vm["series-cache"].as<std::string>();
+
+    // Number of threads for the function evaluations of each iteration
+    int nr_threads = vm["nr-threads"].as<int>();
+
+    // Cache of the roots
+    std::string result_cache_file = vm["result-cache"].as<std::string>();
+
+    // Instrumentation
+    std::string stats_file = vm["stats"].as<std::string>();
+    std::string stats_format = vm["stats-format"].as<std::string>();
+
+    // Jobs read line by line
+    std::string jobs_file = vm["jobs"].as<std::string>();
+
+    // Points where the approximant of the solution is evaluated
+    std::string profile_grid = vm["profile-grid"].as<std::string>();
+    std::string profile_output = vm["profile-output"].as<std::string>();
+    std::string profile_type = vm["profile-type"].as<std::string>();
+
+    // The mode is mandatory unless the jobs provide it
+    if ( ! vm.count("mode") && jobs_file.empty() ) {
+        print_help_message();
+        return 1;
+    }
 
-    // Dmax
-    int Dmax = vm["Dmax"].as<int>();
+    // ------------------------------------------------------------------------
+    // Here we accomodate to the selected options and/or exit the program if 
+    // some of them are wrong
+    // ------------------------------------------------------------------------
 
-    // Step between D values
-    int Dstep = vm["Dstep"].as<int>();
+    // Defaults of the jobs, before validate sets d for the mode
+    const engine::Job defaults = job;
 
-    // d
-    int d = vm["d"].as<int>();
+    std::string error = job.validate();
+    if ( ! error.empty() ) {
+        std::cout << error << std::endl;
+        return 1;
+    }
 
-    // Number of digits for numerical computations
-    int ndigits = vm["ndigits"].as<int>();
-    mpfr_float::default_precision(ndigits);
-    mpfr_float::default_precision(ndigits);
+    if ( hankdet_method.name != "dodgson" 
+            && hankdet_method.name != "chebyshev" ) {
+        std::cout << "hankdet should be either dodgson or chebyshev." 
+            << std::endl;
+        return 1;
+    }
 
-    // Tolerance for the Newton-Raphson method
-    mpfr_float tol;
-    tol = mpfr_float(vm["tol"].as<std::string>());
-
-    // Step size for the Newton-Raphson method
-    mpfr_float h;
-    h = mpfr_float(vm["h"].as<std::string>());
-
-    // Maximum number of Newton-Raphson iterations
-    int maxiter = vm["nr-max-iter"].as<int>();
-    
-    // Check if the user asked for help or if they didn't set the 
-    // mode correctly.
-    const std::vector<std::string> available_modes = {
-        "isolated", "strong-field"
-    };
+    if ( vm["exact-threads"].as<int>() < 1 ) {
+        std::cout << "exact-threads should be at least 1." << std::endl;
+        return 1;
+    }
 
-    if ( vm.count("mode") ) {
-        std::string mode = vm["mode"].as<std::string>();
-        if ( std::none_of(
-                available_modes.begin(),
-                available_modes.end(),
-                [&mode](const std::string &a) -> bool {return a == mode;}
-                )
-           ) {
-            std::cout << "Mode " << mode << " not available." 
-                << std::endl << std::endl;
-            print_help_message("");
-        }
-    } else {
-        print_help_message();
+    if ( vm["scan-threads"].as<int>() < 1 ) {
+        std::cout << "scan-threads should be at least 1." << std::endl;
         return 1;
     }
 
-    if ( d == -1 ) {
-        if ( vm["mode"].as<std::string>() == "isolated" ) {
-            d = 3;
-        } else { 
-            d = 4;
-        }
+    if ( vm["scan-points"].as<int>() < 2 ) {
+        std::cout << "scan-points should be at least 2." << std::endl;
+        return 1;
     }
 
-    // ------------------------------------------------------------------------
-    // Here we accomodate to the selected options and/or exit the program if 
-    // some of them are wrong
-    // ------------------------------------------------------------------------
-    
-    // Dmin and Dmax should be at least 3
-    if ( Dmin < 3 ) {
-        std::cout << "Dmin should be at least 3." << std::endl;
+    if ( vm["scan-digits"].as<int>() < 15 ) {
+        std::cout << "scan-digits should be at least 15." << std::endl;
         return 1;
     }
-    if ( Dmax > -1 && Dmax < 3 ) {
-        std::cout << "Dmax should be at least 3." << std::endl;
+
+    if ( hankdet_threads < 1 ) {
+        std::cout << "hankdet-threads should be at least 1." << std::endl;
         return 1;
     }
 
-    // Handle the numerical precision of our computations
-    if ( ndigits < 15 ) {
-        std::cout << "ndigits should be at least 15." << std::endl;
+    std::unique_ptr<ricpad::ThreadPool> hankdet_pool;
+    if ( hankdet_threads > 1 ) {
+        hankdet_pool.reset(new ricpad::ThreadPool(hankdet_threads));
+        hankdet_method.pool = hankdet_pool.get();
+    }
+
+    if ( nr_threads < 1 ) {
+        std::cout << "nr-threads should be at least 1." << std::endl;
         return 1;
-    } else {
-        mpfr_float::default_precision(ndigits);
     }
 
+    if ( stats_format != "json" && stats_format != "csv" ) {
+        std::cout << "stats-format should be either json or csv." << std::endl;
+        return 1;
+    }
+
+    if ( profile_type != "double" && profile_type != "long-double" ) {
+        std::cout << "profile-type should be either double or long-double." 
+            << std::endl;
+        return 1;
+    }
+
+    if ( ! profile_grid.empty() && ( ! jobs_file.empty() || job.Dmax < 0 ) ) {
+        std::cout << "profile-grid needs a single sweep with a finite Dmax."
+            << std::endl;
+        return 1;
+    }
+
+    // Sweeps of several jobs cannot share a checkpoint, and the other
+    // modes of the program are not sweeps
+    if ( ! jobs_file.empty() && ! job.checkpoint.empty() ) {
+        std::cout << "checkpoint cannot be shared by the jobs; give it in "
+            "the line of each job instead." << std::endl;
+        return 1;
+    }
+
+    if ( ! jobs_file.empty() && ( vm["eval"].as<bool>() 
+                || vm["exact"].as<bool>() || vm["scan"].as<bool>() ) ) {
+        std::cout << "eval, exact and scan cannot be combined with jobs." 
+            << std::endl;
+        return 1;
+    }
+
+    std::ifstream profile_file;
+    if ( ! profile_grid.empty() && profile_grid != "-" ) {
+        profile_file.open(profile_grid);
+        if ( ! profile_file ) {
+            std::cout << "Could not open " << profile_grid << "." << std::endl;
+            return 1;
+        }
+    }
+
+    // The calling thread performs one of the evaluations
+    std::unique_ptr<ricpad::ThreadPool> nr_pool;
+    if ( nr_threads > 1 ) {
+        nr_pool.reset(new ricpad::ThreadPool(nr_threads-1));
+    }
+
+    // Roots found by this and previous runs
+    std::unique_ptr<checkpoint::ResultCache> result_cache;
+    if ( ! result_cache_file.empty() ) 
+        result_cache.reset(new checkpoint::ResultCache(result_cache_file));
+
+    // Everything shared by the solves
+    engine::Engine eng;
+    eng.hankdet = hankdet_method;
+    eng.nr_pool = nr_pool.get();
+    eng.result_cache = result_cache.get();
+    eng.log = vm["log-nr"].as<bool>();
+    eng.set_series_cache(job.strong_field(), series_cache);
+
+    // Records of the cost of each D, added to those already in stats_file
+    // with append
+    std::unique_ptr<stats::Writer> stats_writer;
+    auto open_stats = [&] (const bool append) -> bool {
+        if ( stats_file.empty() ) return true;
+
+        stats_writer.reset(
+                new stats::Writer(stats_file, stats_format, append));
+        eng.stats_writer = stats_writer.get();
+        if ( ! stats_writer->good() ) {
+            std::cout << "Could not open " << stats_file << "." << std::endl;
+            return false;
+        }
+        return true;
+    };
+
+    // Run the jobs read from jobs_file, and print each D as soon as it is 
+    // solved, preceded by the number of its job
+    if ( ! jobs_file.empty() ) {
+        if ( ! open_stats(false) ) return 1;
+
+        std::ifstream file;
+        if ( jobs_file != "-" ) {
+            file.open(jobs_file);
+            if ( ! file ) {
+                std::cout << "Could not open " << jobs_file << "." 
+                    << std::endl;
+                return 1;
+            }
+        }
+        std::istream &in = jobs_file == "-" ? std::cin : file;
+
+        std::string line;
+        int njob = 0;
+
+        while ( std::getline(in, line) ) {
+            if ( line.find_first_not_of(" \t") == std::string::npos 
+                    || line[line.find_first_not_of(" \t")] == '#' ) continue;
+
+            engine::Job j = defaults;
+            j.Dmax = -1;
+
+            njob++;
+            std::string error = j.parse(line);
+            // An unbounded sweep would never let the next job start
+            if ( j.Dmax == -1 ) j.Dmax = j.Dmin;
+            if ( error.empty() ) error = j.validate();
+            if ( error.empty() && j.Dmax < j.Dmin ) 
+                error = "Dmax should be at least Dmin.";
+
+            if ( error.empty() ) {
+                try {
+                    const std::string prefix = 
+                        "job " + std::to_string(njob) + " ";
+
+                    eng.sweep(j, [&] (const engine::Step &step) {
+                        std::cout << prefix << "D = " << step.D;
+
+                        if ( step.converged ) {
+                            std::cout 
+                                << " " << std::setprecision(step.ndigits) 
+                                << step.root.x 
+                                << " " << std::setprecision(4) << step.dE
+                                << " digits: " << step.ndigits
+                                << " iters: " << step.root.iterations
+                                << " evals: " << step.root.evaluations;
+                            if ( j.accel != "none" ) 
+                                std::cout 
+                                    << " accel: " 
+                                    << std::setprecision(step.ndigits) 
+                                    << step.xaccel;
+                        } else {
+                            std::cout << " failed";
+                        }
+
+                        std::cout << std::endl;
+
+                        if ( step.converged && j.certify > 0 ) 
+                            print_enclosure(
+                                    prefix, step.enclosure, j.certify);
+
+                        for ( const auto &c : step.cross ) 
+                            print_cross(
+                                prefix, c, 
+                                step.converged ? &step.root.x : nullptr);
+                    });
+                } catch ( const std::runtime_error& e ) {
+                    error = e.what();
+                }
+            }
+
+            if ( error.empty() ) {
+                std::cout << "job " << njob << " done" << std::endl;
+            } else {
+                std::cout << "job " << njob << " error: " << error 
+                    << std::endl;
+            }
+        }
+
+        return 0;
+    }
+
+    // From here on, a single sweep described by the options
+    const std::string mode = job.mode;
+    const bool strong_field = job.strong_field();
+    int Dmin = job.Dmin, Dmax = job.Dmax, Dstep = job.Dstep, d = job.d;
+    int ndigits = job.ndigits;
+    const int maxiter = job.maxiter;
+
+    mpfr_float::default_precision(ndigits);
+
+    // Tolerance and step size for the Newton-Raphson method
+    mpfr_float tol(job.tol), h(job.h);
+
     // Initial x0 value
-    mpfr_float x0;
-    x0 = mpfr_float(vm["x0"].as<std::string>());
+    mpfr_float x0(job.x0);
 
     int D;
 
-    // Define the lambda function for the Hankel determinants
-    std::function<mpfr_float(mpfr_float&)> f;
-
-    if ( vm["mode"].as<std::string>() == "strong-field" ) {
-        f = [&D, &d] ( mpfr_float &x ) -> mpfr_float {
-            std::vector<mpfr_float> v;
-
-            v = coefs_strong<mpfr_float>(2*D+d, x/2);
-            v.erase(v.begin(), v.begin()+d+1);
-            return ricpad::hankdet::hankdet<mpfr_float>(D, v);
-        };
-    } else if ( vm["mode"].as<std::string>() == "isolated" ) {
-        f = [&D, &d] ( mpfr_float &x ) -> mpfr_float {
-            std::vector<mpfr_float> v;
-
-            v = coefs<mpfr_float>(2*D+d, x/2);
-            v.erase(v.begin(), v.begin()+d+1);
-            return ricpad::hankdet::hankdet<mpfr_float>(D, v);
-        };
-    }
+    // Make sure the polynomials reach f[N]
+    if ( job.series == "polynomial" && Dmax >= 0 ) 
+        eng.polynomials(strong_field, 2*Dmax+d);
 
-    // Here we define the Solver object that will solve the H[D,d] = 0 equation.
-    solver::Solver<mpfr_float, mpfr_float> s(f);
-    s.set_tol(tol);
-    s.set_h(h);
-    s.set_maxiter(maxiter);
+    // Evaluate the Hankel determinants at x0 for all D and exit
+    if ( vm["eval"].as<bool>() ) {
+        if ( Dmax < Dmin ) {
+            std::cout << "eval needs Dmax >= Dmin." << std::endl;
+            return 1;
+        }
 
-    // ------------------------------------------------------------------------
-    // Here starts the actual computation
-    // ------------------------------------------------------------------------
+        std::vector<mpfr_float> v, dets;
 
-    mpfr_float x, xtry, xold;
-    x = x0;
-    mpfr_float dE;
+        if ( job.series == "polynomial" ) {
+            v = eng.polynomials(strong_field, 2*Dmax+d)
+                ->coefs<mpfr_float>(2*Dmax+d, x0/2);
+        } else if ( strong_field ) {
+            v = coefs_strong<mpfr_float>(2*Dmax+d, x0/2);
+        } else {
+            v = coefs<mpfr_float>(2*Dmax+d, x0/2);
+        }
+        v.erase(v.begin(), v.begin()+d+1);
 
-    int nfailed = 0;
+        if ( hankdet_method.name == "chebyshev" ) {
+            dets = ricpad::hankdet::hankdets_chebyshev<mpfr_float>(
+                    Dmin, Dmax, v);
+        } else {
+            dets = ricpad::hankdet::hankdets<mpfr_float>(Dmin, Dmax, v);
+        }
 
-    for ( D = Dmin; Dmax < 0 || D<=Dmax ; D = D + Dstep ) {
-        mpfr_float ans;
+        for ( D = Dmin; D <= Dmax; D += Dstep ) {
+            std::cout 
+                << "D = " << std::setw(3) << D 
+                << " H = " << std::setprecision(ndigits) << dets[D-Dmin]
+                << std::endl;
+        }
 
-        if ( vm["log-nr"].as<bool>() ) {
-            s.set_log(ndigits);
+        return 0;
+    }
+
+    // Find H[D,d] exactly and all its roots for all D and exit
+    if ( vm["exact"].as<bool>() ) {
+        if ( Dmax < Dmin ) {
+            std::cout << "exact needs Dmax >= Dmin." << std::endl;
+            return 1;
         }
 
-        try { 
-            xtry = s.solve(x);
-            xold = x;
-            x = xtry;
+        const int exact_threads = vm["exact-threads"].as<int>();
+        std::unique_ptr<ricpad::ThreadPool> exact_pool;
+        if ( exact_threads > 1 ) 
+            exact_pool.reset(new ricpad::ThreadPool(exact_threads));
+
+        const std::string exact_output = vm["exact-output"].as<std::string>();
+        std::ofstream out;
+        if ( ! exact_output.empty() ) {
+            out.open(exact_output);
+            if ( ! out ) {
+                std::cout << "Could not open " << exact_output << "." 
+                    << std::endl;
+                return 1;
+            }
+        }
 
-            dE = abs(x - xold);
+        typedef ricpad::aberth::Complex<mpfr_float> complex_t;
 
-            //if ( ! vm["no-auto-precision"].as<bool>() ) {
-                int curr_ndigits = -int(floor(log10(dE)));
-                tol = mp::min(tol, dE/1e10);
-                h = tol*tol;
-                ndigits = std::max(4*curr_ndigits, ndigits);
-                ndigits = std::max(-2*int(floor(log10(h))), ndigits);
-            //}
+        for ( D = Dmin; D <= Dmax; D += Dstep ) {
+            const auto start = std::chrono::steady_clock::now();
+            int primes;
+            const exact::Polynomial H = exact::hankel_polynomial(
+                    strong_field, D, d, exact_pool.get(), &primes);
+            const double time = stats::seconds_since(start);
+
+            if ( out ) {
+                out << "D = " << D << " den: " << H.den << "\n";
+                for ( int k = 0; k < int(H.num.size()); k++ ) 
+                    out << "x^" << k << ": " << H.num[k] << "\n";
+                out.flush();
+            }
+
+            exact::Roots r = exact::roots(H, ndigits);
+            std::vector<complex_t>& z = r.z;
+
+            std::sort(z.begin(), z.end(), 
+                    [&x0] (const complex_t &u, const complex_t &v) -> bool {
+                        return hypot(u.re - x0, u.im) < hypot(v.re - x0, v.im);
+                    });
 
             std::cout 
                 << "D = " << std::setw(3) << D 
-                << " " << std::setw(ndigits+5) 
-                       << std::setprecision(ndigits) << std::left << x 
-                << " " << std::setw(10) << std::setprecision(4) << dE
-                << " digits: " << ndigits 
-                << " tol: " << tol 
-                << " h: " << h; 
+                << " degree: " << int(H.num.size()) - 1
+                << " primes: " << primes
+                << " time: " << std::setprecision(3) << time
+                << " iters: " << r.iterations 
+                << " digits: " << r.ndigits
+                << ( r.converged ? "" : " not converged" ) 
+                << ( r.stable ? "" : " not stable" ) 
+                << ( r.conjugate ? "" : " not conjugate" ) << std::endl;
+
+            for ( const auto &u : z ) {
+                std::cout << "    " << std::setprecision(ndigits) << u.re;
+                if ( abs(u.im) > tol*mp::max(mpfr_float(1), abs(u.re)) ) 
+                    std::cout << " " << std::showpos << std::setprecision(4) 
+                        << u.im << std::noshowpos << " i";
+                std::cout << std::endl;
+            }
+        }
 
-            std::cout << std::endl;
+        return 0;
+    }
 
-            //if ( ! vm["no-auto-precision"].as<bool>() ) {
-                mpfr_float::default_precision(ndigits);
-                s.set_tol(tol);
-                s.set_h(h);
-            //}
+    // Look for all the roots in an interval of x for all D and exit
+    if ( vm["scan"].as<bool>() ) {
+        if ( Dmax < Dmin ) {
+            std::cout << "scan needs Dmax >= Dmin." << std::endl;
+            return 1;
+        }
 
+        mpfr_float xmin, xmax;
+        try {
+            xmin = mpfr_float(vm["scan-min"].as<std::string>());
+            xmax = mpfr_float(vm["scan-max"].as<std::string>());
         } catch ( const std::runtime_error& e ) {
-            nfailed += 1;
+            std::cout << "scan-min and scan-max should be numbers." 
+                << std::endl;
+            return 1;
+        }
+
+        if ( xmin >= xmax ) {
+            std::cout << "scan-min should be less than scan-max." << std::endl;
+            return 1;
+        }
+
+        const int scan_threads = vm["scan-threads"].as<int>();
+        std::unique_ptr<ricpad::ThreadPool> scan_pool;
+        if ( scan_threads > 1 ) 
+            scan_pool.reset(new ricpad::ThreadPool(scan_threads));
+
+        for ( D = Dmin; D <= Dmax; D += Dstep ) {
+            const engine::Scan scan = eng.scan(
+                    job, D, xmin, xmax, vm["scan-points"].as<int>(), 
+                    vm["scan-digits"].as<int>(), ndigits, tol, h, 
+                    scan_pool.get());
+
             std::cout 
-                << "Newton-Raphson failed after " << s.maxiter() 
-                << " iterations for D = " << D << "." << std::endl;
-
-            if ( nfailed >= 3 ) {
-                throw std::runtime_error(
-                    "The Newton-Raphson method failed to converge for " + 
-                    std::to_string(nfailed) + " consecutive D values. "
-                    );
+                << "D = " << std::setw(3) << D 
+                << " roots: " << std::count_if(
+                        scan.roots.begin(), scan.roots.end(), 
+                        [] (const engine::ScanRoot &r) -> bool {
+                            return r.converged;
+                        })
+                << " unknown signs: " << scan.uncertain << std::endl;
+
+            for ( const auto &r : scan.roots ) {
+                std::cout << "    ";
+                if ( r.converged ) {
+                    std::cout 
+                        << std::setprecision(ndigits) << r.root.x
+                        << " iters: " << r.root.iterations
+                        << " evals: " << r.root.evaluations;
+                } else {
+                    std::cout << "no root";
+                }
+
+                std::cout 
+                    << ( r.bracketed ? " sign change in [" : " minimum in [" )
+                    << std::setprecision(6) << r.a << ", " << r.b << "]" 
+                    << std::endl;
             }
         }
+
+        return 0;
+    }
+
+    // ------------------------------------------------------------------------
+    // Here starts the actual computation
+    // ------------------------------------------------------------------------
+
+    // Resume the sweep stored in the checkpoint, if any
+    checkpoint::SweepState state;
+    bool resumed = false;
+    try {
+        resumed = engine::Engine::resume(job, state);
+    } catch ( const std::runtime_error& e ) {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+
+    if ( resumed ) {
+        std::cout << "Resuming from " << job.checkpoint << " after D = " 
+            << state.D << "." << std::endl;
+    }
+
+    if ( ! open_stats(resumed) ) return 1;
+
+    // The last root of the sweep and its D, from which the profile is built
+    mpfr_float xlast;
+    int Dlast = -1;
+    if ( resumed && ! state.roots.empty() ) {
+        xlast = state.roots.back();
+        Dlast = state.roots_D.back();
+    }
+
+    // Evaluate the approximant of the solution built from the last root at
+    // the points of profile_grid, if any. Returns the exit status of the
+    // program.
+    auto profile_from_root = [&] () -> int {
+        if ( profile_grid.empty() ) return 0;
+
+        if ( Dlast < 0 ) {
+            std::cout << "No root to build the profile from." << std::endl;
+            return 1;
+        }
+
+        std::istream &in = profile_grid == "-" ? std::cin : profile_file;
+        FILE* out = profile_output.empty() ? 
+            stdout : std::fopen(profile_output.c_str(), "w");
+        if ( ! out ) {
+            std::cout << "Could not open " << profile_output << "." 
+                << std::endl;
+            return 1;
+        }
+
+        bool ok = false;
+        try {
+            if ( profile_type == "double" ) {
+                ok = write_profile(profile::Profile<double>(
+                            strong_field, Dlast, xlast), in, out);
+            } else {
+                ok = write_profile(profile::Profile<long double>(
+                            strong_field, Dlast, xlast), in, out);
+            }
+        } catch ( const std::runtime_error& e ) {
+            std::cout << e.what() << std::endl;
+        }
+
+        if ( out != stdout ) std::fclose(out);
+        else std::fflush(out);
+
+        return ok ? 0 : 1;
+    };
+
+    // Print each D of the sweep as it is done: its root and the precision,
+    // tolerance and step size for the following D values
+    try {
+        eng.sweep(job, [&] (const engine::Step &step) {
+            if ( ! step.converged ) {
+                for ( const auto &c : step.cross ) print_cross("", c, nullptr);
+                std::cout 
+                    << "Newton-Raphson failed after " << maxiter 
+                    << " iterations for D = " << step.D << "." << std::endl;
+                return;
+            }
+
+            xlast = step.root.x;
+            Dlast = step.D;
+
+            std::cout 
+                << "D = " << std::setw(3) << step.D 
+                << " " << std::setw(step.ndigits+5) 
+                       << std::setprecision(step.ndigits) << std::left 
+                       << step.root.x 
+                << " " << std::setw(10) << std::setprecision(4) << step.dE
+                << " digits: " << step.ndigits 
+                << " tol: " << step.tol 
+                << " h: " << step.h
+                << " iters: " << step.root.iterations
+                << " evals: " << step.root.evaluations; 
+
+            if ( job.precision_control == "error-bound" ) 
+                std::cout << " lost: " << std::setprecision(3) 
+                    << step.root.loss;
+
+            if ( job.accel != "none" ) 
+                std::cout 
+                    << " accel: " << std::setprecision(step.ndigits) 
+                    << step.xaccel;
+
+            std::cout << std::endl;
+
+            if ( job.certify > 0 ) 
+                print_enclosure("", step.enclosure, job.certify);
+
+            for ( const auto &c : step.cross ) 
+                print_cross("", c, &step.root.x);
+        });
+    } catch ( const std::runtime_error& e ) {
+        std::cout << e.what() << std::endl;
+        return 1;
     }
 
-    return 0;
+    return profile_from_root();
 }